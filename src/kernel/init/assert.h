@@ -1,17 +1,13 @@
 #ifndef ASSERT_H
 #define ASSERT_H
 
-#include "terminal.h"
+#include "panic.h"
 
 #undef ASSERT
 
 #define ASSERT(c, m)                                                           \
     if (!(c)) {                                                                \
-        terminal_printf("\n");                                                 \
-        terminal_printf("ASSERT FAILED: %s: %s\n", __FILE__, m);               \
-        for (;;) {                                                             \
-            ;                                                                  \
-        }                                                                      \
+        panic(__FILE__, __LINE__, m);                                          \
     }
 
 #endif // ASSERT_H
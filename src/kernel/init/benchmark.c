@@ -0,0 +1,227 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "assert.h"
+#include "benchmark.h"
+#include "clock.h"
+#include "cpu.h"
+#include "pci.h"
+#include "pci_ids.h"
+#include "pci_ids_table.h"
+#include "task.h"
+#include "terminal.h"
+#include "timer.h"
+
+#define BENCHMARK_TIMER_COUNT 64
+#define BENCHMARK_TIMER_EXPIRE_DELAY_NS (5 * CLOCK_NS_PER_MS)
+#define BENCHMARK_JITTER_ROUNDS 16
+#define BENCHMARK_YIELD_COUNT 1000
+#define BENCHMARK_SLEEP_NS (10 * CLOCK_NS_PER_MS)
+#define BENCHMARK_PCI_IDS_ROUNDS 100
+
+static struct timer benchmark_timers[BENCHMARK_TIMER_COUNT];
+static volatile uint32_t benchmark_fired_count;
+static volatile uint64_t benchmark_first_fired_tsc;
+static volatile uint64_t benchmark_last_fired_tsc;
+static volatile uint64_t benchmark_fired_ns;
+
+static void benchmark_timer_callback(void *arg)
+{
+    (void)arg;
+
+    const uint64_t tsc = cpu_read_tsc();
+
+    if (benchmark_fired_count == 0) {
+        benchmark_first_fired_tsc = tsc;
+    }
+    benchmark_last_fired_tsc = tsc;
+    benchmark_fired_ns = ktime_ns();
+    ++benchmark_fired_count;
+}
+
+static void benchmark_wait_for_timers(uint32_t count)
+{
+    cpu_disable_interrupts();
+    while (benchmark_fired_count < count) {
+        cpu_wait_for_interrupt();
+        cpu_disable_interrupts();
+    }
+    cpu_enable_interrupts();
+}
+
+static void benchmark_timer_insert_cancel(void)
+{
+    const uint64_t start = cpu_read_tsc();
+    for (uint32_t i = 0; i < BENCHMARK_TIMER_COUNT; ++i) {
+        // Spread the timers over all the levels of the timer wheel
+        timer_arm(&benchmark_timers[i], ((uint64_t)i * i * i) * CLOCK_NS_PER_MS,
+                  benchmark_timer_callback, NULL);
+    }
+    const uint64_t armed = cpu_read_tsc();
+    for (uint32_t i = 0; i < BENCHMARK_TIMER_COUNT; ++i) {
+        timer_cancel(&benchmark_timers[i]);
+    }
+    const uint64_t cancelled = cpu_read_tsc();
+
+    terminal_printf("  timer_arm:    %u cycles\n",
+                    (uint32_t)((armed - start) / BENCHMARK_TIMER_COUNT));
+    terminal_printf("  timer_cancel: %u cycles\n",
+                    (uint32_t)((cancelled - armed) / BENCHMARK_TIMER_COUNT));
+}
+
+static void benchmark_timer_expire(void)
+{
+    /* All the timers must expire in the same tick, so they are processed
+     * together. With a relative delay, a tick boundary crossed during the loop
+     * would split them into two ticks. The deadline is in the middle of a tick,
+     * so the time that passes within timer_arm() does not move it to the next
+     * one.
+     */
+    const uint64_t deadline =
+        (((ktime_ns() + BENCHMARK_TIMER_EXPIRE_DELAY_NS) >> TIMER_TICK_SHIFT)
+         << TIMER_TICK_SHIFT) +
+        (TIMER_TICK_NS / 2);
+
+    benchmark_fired_count = 0;
+    for (uint32_t i = 0; i < BENCHMARK_TIMER_COUNT; ++i) {
+        timer_arm(&benchmark_timers[i], deadline - ktime_ns(),
+                  benchmark_timer_callback, NULL);
+    }
+    benchmark_wait_for_timers(BENCHMARK_TIMER_COUNT);
+
+    terminal_printf("  expire:       %u cycles\n",
+                    (uint32_t)((benchmark_last_fired_tsc -
+                                benchmark_first_fired_tsc) /
+                               (BENCHMARK_TIMER_COUNT - 1)));
+}
+
+static void benchmark_timer_jitter(void)
+{
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    uint64_t sum = 0;
+
+    for (uint32_t i = 1; i <= BENCHMARK_JITTER_ROUNDS; ++i) {
+        const uint64_t delay = i * CLOCK_NS_PER_MS;
+
+        benchmark_fired_count = 0;
+        const uint64_t armed = ktime_ns();
+        timer_arm(&benchmark_timers[0], delay, benchmark_timer_callback, NULL);
+        benchmark_wait_for_timers(1);
+
+        const uint32_t late = (uint32_t)(benchmark_fired_ns - armed - delay);
+        min = (late < min) ? late : min;
+        max = (late > max) ? late : max;
+        sum += late;
+    }
+
+    terminal_printf("  wakeup late:  min %u ns  avg %u ns  max %u ns\n", min,
+                    (uint32_t)(sum / BENCHMARK_JITTER_ROUNDS), max);
+}
+
+static void benchmark_yield_task(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t i = 0; i < BENCHMARK_YIELD_COUNT; ++i) {
+        task_yield();
+    }
+}
+
+static void benchmark_sleep_task(void *arg)
+{
+    (void)arg;
+
+    task_sleep(BENCHMARK_SLEEP_NS);
+}
+
+static void benchmark_task_yield(void)
+{
+    struct task *const task =
+        task_create("benchmark yield", benchmark_yield_task, NULL);
+    ASSERT(task != NULL, "Cannot create benchmark task");
+
+    const uint64_t start = cpu_read_tsc();
+    for (uint32_t i = 0; i < BENCHMARK_YIELD_COUNT; ++i) {
+        task_yield();
+    }
+    const uint64_t end = cpu_read_tsc();
+    task_join(task);
+
+    // Each round trip consists of two context switches
+    terminal_printf("  yield:        %u cycles\n",
+                    (uint32_t)((end - start) / (2 * BENCHMARK_YIELD_COUNT)));
+}
+
+static void benchmark_task_overlap(void)
+{
+    const uint64_t start = ktime_ns();
+    struct task *const first =
+        task_create("benchmark sleep", benchmark_sleep_task, NULL);
+    struct task *const second =
+        task_create("benchmark sleep", benchmark_sleep_task, NULL);
+    ASSERT((first != NULL) && (second != NULL),
+           "Cannot create benchmark task");
+
+    task_join(first);
+    task_join(second);
+    const uint64_t end = ktime_ns();
+
+    terminal_printf("  2 tasks sleeping %u us each: %u us in total\n",
+                    (uint32_t)(BENCHMARK_SLEEP_NS / 1000),
+                    (uint32_t)((end - start) / 1000));
+}
+
+static void benchmark_pci_ids_lookup(void)
+{
+    const uint32_t count = pci_ids_devices.entry_count;
+    uint32_t found = 0;
+
+    if (count == 0) {
+        return;
+    }
+
+    const uint64_t start = cpu_read_tsc();
+    for (uint32_t r = 0; r < BENCHMARK_PCI_IDS_ROUNDS; ++r) {
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t key = pci_ids_devices.keys[i];
+            found += (pci_ids_device_name((uint16_t)(key >> 16),
+                                          (uint16_t)key) != NULL);
+        }
+    }
+    const uint64_t present = cpu_read_tsc();
+    // No device of the invalid vendor ID is in the database
+    for (uint32_t r = 0; r < BENCHMARK_PCI_IDS_ROUNDS; ++r) {
+        for (uint32_t i = 0; i < count; ++i) {
+            found += (pci_ids_device_name(PCI_INVALID_VENDOR_ID,
+                                          (uint16_t)i) != NULL);
+        }
+    }
+    const uint64_t absent = cpu_read_tsc();
+
+    ASSERT(found == (BENCHMARK_PCI_IDS_ROUNDS * count),
+           "PCI ID lookup failed");
+
+    const uint32_t lookup_count = BENCHMARK_PCI_IDS_ROUNDS * count;
+    terminal_printf("  present:      %u cycles\n",
+                    (uint32_t)((present - start) / lookup_count));
+    terminal_printf("  absent:       %u cycles\n",
+                    (uint32_t)((absent - present) / lookup_count));
+}
+
+void benchmark_run(void)
+{
+    terminal_printf("\n");
+    terminal_printf("Timer benchmark:\n");
+    benchmark_timer_insert_cancel();
+    benchmark_timer_expire();
+    benchmark_timer_jitter();
+
+    terminal_printf("Task benchmark:\n");
+    benchmark_task_yield();
+    benchmark_task_overlap();
+
+    terminal_printf("PCI ID lookup benchmark (%u devices):\n",
+                    (uint32_t)pci_ids_devices.entry_count);
+    benchmark_pci_ids_lookup();
+}
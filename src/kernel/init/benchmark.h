@@ -0,0 +1,6 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+void benchmark_run(void);
+
+#endif
@@ -41,6 +41,17 @@ stack_bottom:
 .skip 16384 # 16 KiB
 stack_top:
 
+/*
+The bootloader passes an address of the multiboot information structure in the
+ebx register. It is saved here before the compiled code has a chance to
+overwrite the register.
+*/
+.section .bss
+.align 4
+.global multiboot_info_struct_address
+multiboot_info_struct_address:
+.skip 4
+
 /*
 The linker script specifies _start as the entry point to the kernel and the
 bootloader will jump to this position once the kernel has been loaded. It
@@ -68,8 +79,23 @@ _start:
         stack (as it grows downwards on x86 systems). This is necessarily done
         in assembly as languages such as C cannot function without a stack.
         */
+        /*
+        The .bss section is not a part of the binary image loaded by the
+        bootloader, so it may contain garbage. The C code expects it to be
+        zeroed. The stack is in it too, so this is done before it is used.
+        The ebx register must be preserved.
+        */
+        cld
+        mov $__bss_start, %edi
+        mov $__bss_end, %ecx
+        sub %edi, %ecx
+        xor %eax, %eax
+        rep stosb
+
         mov $stack_top, %esp
 
+        mov %ebx, multiboot_info_struct_address
+
         /*
         This is a good place to initialize crucial processor state before the
         high-level kernel is entered. It's best to minimize the early
@@ -87,8 +113,10 @@ _start:
         the return pointer of size 4 bytes). The stack was originally 16-byte
         aligned above and we've pushed a multiple of 16 bytes to the
         stack since (pushed 0 bytes so far), so the alignment has thus been
-        preserved and the call is well defined.
+        preserved and the call is well defined. The zero frame pointer
+        terminates the backtrace printed on a kernel panic.
         */
+        xor %ebp, %ebp
         call kernel_main
 
         /*
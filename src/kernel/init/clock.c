@@ -0,0 +1,143 @@
+#include <stdint.h>
+
+#include "assert.h"
+#include "clock.h"
+#include "cpu.h"
+#include "io_port.h"
+#include "lapic.h"
+
+#define PIT_FREQUENCY_HZ 1193182U
+
+#define PIT_IO_CHANNEL2_DATA 0x42
+#define PIT_IO_COMMAND 0x43
+#define PIT_IO_CHANNEL2_CONTROL 0x61
+
+// Channel 2, access low byte then high byte, mode 0 (interrupt on terminal
+// count), binary counting
+#define PIT_COMMAND_CHANNEL2_ONE_SHOT 0xB0
+
+#define PIT_CHANNEL2_CONTROL_GATE (1U << 0)
+#define PIT_CHANNEL2_CONTROL_SPEAKER (1U << 1)
+#define PIT_CHANNEL2_CONTROL_OUTPUT (1U << 5)
+
+#define CLOCK_CALIBRATION_MS 10U
+#define CLOCK_CALIBRATION_PIT_COUNT                                            \
+    ((PIT_FREQUENCY_HZ * CLOCK_CALIBRATION_MS) / 1000U)
+
+/* Conversions between the clocks are done by multiplying by a fixed-point
+ * factor with this many fractional bits, so there is no division on the hot
+ * paths.
+ */
+#define CLOCK_MULT_SHIFT 24
+
+static uint64_t clock_tsc_base;
+static uint32_t clock_tsc_khz;
+static uint32_t clock_lapic_timer_khz;
+// Nanoseconds per TSC cycle
+static uint32_t clock_tsc_to_ns_mult;
+// LAPIC timer counts per nanosecond
+static uint32_t clock_ns_to_lapic_mult;
+
+/* Use the PIT channel 2 as a reference because its frequency is fixed and, as
+ * opposed to channel 0, it can be polled without interrupts.
+ */
+static void clock_calibrate(void)
+{
+    uint8_t control = io_port_in_byte(PIT_IO_CHANNEL2_CONTROL);
+
+    control &= ~(PIT_CHANNEL2_CONTROL_GATE | PIT_CHANNEL2_CONTROL_SPEAKER);
+    io_port_out_byte(PIT_IO_CHANNEL2_CONTROL, control);
+
+    io_port_out_byte(PIT_IO_COMMAND, PIT_COMMAND_CHANNEL2_ONE_SHOT);
+    io_port_out_byte(PIT_IO_CHANNEL2_DATA,
+                     (uint8_t)CLOCK_CALIBRATION_PIT_COUNT);
+    io_port_out_byte(PIT_IO_CHANNEL2_DATA,
+                     (uint8_t)(CLOCK_CALIBRATION_PIT_COUNT >> 8));
+
+    // Rising edge on the gate starts the countdown
+    io_port_out_byte(PIT_IO_CHANNEL2_CONTROL,
+                     control | PIT_CHANNEL2_CONTROL_GATE);
+    const uint64_t tsc_start = cpu_read_tsc();
+    lapic_timer_start(LAPIC_TIMER_MAX_COUNT);
+
+    while ((io_port_in_byte(PIT_IO_CHANNEL2_CONTROL) &
+            PIT_CHANNEL2_CONTROL_OUTPUT) == 0) {
+        ;
+    }
+
+    const uint64_t tsc_end = cpu_read_tsc();
+    const uint32_t lapic_remaining = lapic_timer_read_count();
+    lapic_timer_stop();
+
+    io_port_out_byte(PIT_IO_CHANNEL2_CONTROL, control);
+
+    clock_tsc_khz = (uint32_t)((tsc_end - tsc_start) / CLOCK_CALIBRATION_MS);
+    clock_lapic_timer_khz =
+        (LAPIC_TIMER_MAX_COUNT - lapic_remaining) / CLOCK_CALIBRATION_MS;
+}
+
+void clock_initialize(void)
+{
+    struct cpu_cpuid_result features;
+
+    cpu_cpuid(CPU_CPUID_LEAF_FEATURES, &features);
+    ASSERT((features.edx & CPU_CPUID_FEATURES_EDX_TSC) != 0,
+           "TSC not supported");
+
+    clock_calibrate();
+
+    // The multiplication factors must fit in 32 bits
+    ASSERT(clock_tsc_khz >= (CLOCK_NS_PER_MS >> (32 - CLOCK_MULT_SHIFT)),
+           "TSC frequency too low");
+    ASSERT((clock_lapic_timer_khz > 0) &&
+               (clock_lapic_timer_khz < (CLOCK_NS_PER_MS << 8)),
+           "LAPIC timer frequency out of range");
+
+    clock_tsc_to_ns_mult =
+        (uint32_t)((((uint64_t)CLOCK_NS_PER_MS) << CLOCK_MULT_SHIFT) /
+                   clock_tsc_khz);
+    clock_ns_to_lapic_mult =
+        (uint32_t)((((uint64_t)clock_lapic_timer_khz) << CLOCK_MULT_SHIFT) /
+                   CLOCK_NS_PER_MS);
+
+    clock_tsc_base = cpu_read_tsc();
+}
+
+uint64_t ktime_ns(void)
+{
+    const uint64_t cycles = cpu_read_tsc() - clock_tsc_base;
+    const uint32_t cycles_low = (uint32_t)cycles;
+    const uint32_t cycles_high = (uint32_t)(cycles >> 32);
+
+    /* Multiply the halves separately to avoid overflowing 64 bits after a few
+     * minutes of uptime.
+     */
+    return ((((uint64_t)cycles_low) * clock_tsc_to_ns_mult) >>
+            CLOCK_MULT_SHIFT) +
+           ((((uint64_t)cycles_high) * clock_tsc_to_ns_mult)
+            << (32 - CLOCK_MULT_SHIFT));
+}
+
+uint32_t clock_get_tsc_khz(void) { return clock_tsc_khz; }
+
+uint32_t clock_get_lapic_timer_khz(void) { return clock_lapic_timer_khz; }
+
+uint32_t clock_ns_to_lapic_timer_count(uint64_t ns)
+{
+    // Largest value that does not overflow the multiplication
+    const uint64_t max_ns = UINT64_MAX >> 32;
+
+    if (ns > max_ns) {
+        ns = max_ns;
+    }
+
+    const uint64_t count = (ns * clock_ns_to_lapic_mult) >> CLOCK_MULT_SHIFT;
+
+    if (count == 0) {
+        return 1;
+    } else if (count > LAPIC_TIMER_MAX_COUNT) {
+        return LAPIC_TIMER_MAX_COUNT;
+    } else {
+        return (uint32_t)count;
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+#define CLOCK_NS_PER_MS 1000000U
+
+void clock_initialize(void);
+
+uint64_t ktime_ns(void);
+
+uint32_t clock_get_tsc_khz(void);
+uint32_t clock_get_lapic_timer_khz(void);
+uint32_t clock_ns_to_lapic_timer_count(uint64_t ns);
+
+#endif
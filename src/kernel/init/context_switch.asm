@@ -0,0 +1,31 @@
+/*
+void context_switch(uint32_t *old_stack_pointer, uint32_t new_stack_pointer)
+
+Save the callee-saved registers on the current stack, store the stack pointer
+to old_stack_pointer, switch to the new stack and restore the callee-saved
+registers from it. The caller-saved registers have already been saved by the
+compiler, if needed, before calling this function. The return address on the
+new stack determines where the execution continues.
+*/
+.section .text
+.global context_switch
+.type context_switch, @function
+context_switch:
+        movl    4(%esp), %eax
+        movl    8(%esp), %edx
+
+        pushl   %ebp
+        pushl   %ebx
+        pushl   %esi
+        pushl   %edi
+
+        movl    %esp, (%eax)
+        movl    %edx, %esp
+
+        popl    %edi
+        popl    %esi
+        popl    %ebx
+        popl    %ebp
+
+        ret
+.size context_switch, . - context_switch
@@ -0,0 +1,158 @@
+#include <stdbool.h>
+
+#include "cpu.h"
+
+#define CPU_EFLAGS_INTERRUPT_ENABLE (1U << 9)
+
+// Wake up from MWAIT on an interrupt even if the interrupts are disabled
+#define CPU_MWAIT_ECX_INTERRUPT_BREAK 0x01
+
+static bool cpu_mwait_supported;
+// Address monitored by MONITOR, nothing writes to it
+static volatile uint32_t cpu_monitor_line;
+
+void cpu_initialize(void)
+{
+    struct cpu_cpuid_result result;
+
+    cpu_cpuid(CPU_CPUID_LEAF_MAX, &result);
+    const uint32_t max_leaf = result.eax;
+
+    cpu_cpuid(CPU_CPUID_LEAF_FEATURES, &result);
+    cpu_mwait_supported = false;
+    if (((result.ecx & CPU_CPUID_FEATURES_ECX_MONITOR) != 0) &&
+        (max_leaf >= CPU_CPUID_LEAF_MONITOR)) {
+        cpu_cpuid(CPU_CPUID_LEAF_MONITOR, &result);
+        cpu_mwait_supported =
+            ((result.ecx & CPU_CPUID_MONITOR_ECX_INTERRUPT_BREAK) != 0);
+    }
+}
+
+void cpu_cpuid(uint32_t leaf, struct cpu_cpuid_result *const result)
+{
+    __asm__ volatile("cpuid"
+                     : "=a"(result->eax), "=b"(result->ebx),
+                       "=c"(result->ecx), "=d"(result->edx)
+                     : "a"(leaf), "c"(0));
+}
+
+uint32_t cpu_read_cr0(void)
+{
+    uint32_t value;
+
+    __asm__ volatile("mov %%cr0, %0" : "=r"(value));
+
+    return value;
+}
+
+uint32_t cpu_read_cr2(void)
+{
+    uint32_t value;
+
+    __asm__ volatile("mov %%cr2, %0" : "=r"(value));
+
+    return value;
+}
+
+uint32_t cpu_read_cr3(void)
+{
+    uint32_t value;
+
+    __asm__ volatile("mov %%cr3, %0" : "=r"(value));
+
+    return value;
+}
+
+uint32_t cpu_read_cr4(void)
+{
+    uint32_t value;
+
+    __asm__ volatile("mov %%cr4, %0" : "=r"(value));
+
+    return value;
+}
+
+uint64_t cpu_read_tsc(void)
+{
+    uint32_t low;
+    uint32_t high;
+
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+
+    return (((uint64_t)high) << 32) | low;
+}
+
+uint64_t cpu_read_msr(uint32_t msr)
+{
+    uint32_t low;
+    uint32_t high;
+
+    __asm__ volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+
+    return (((uint64_t)high) << 32) | low;
+}
+
+void cpu_write_msr(uint32_t msr, uint64_t value)
+{
+    const uint32_t low = (uint32_t)value;
+    const uint32_t high = (uint32_t)(value >> 32);
+
+    __asm__ volatile("wrmsr" : : "a"(low), "d"(high), "c"(msr));
+}
+
+void cpu_enable_interrupts(void) { __asm__ volatile("sti" : : : "memory"); }
+
+void cpu_disable_interrupts(void) { __asm__ volatile("cli" : : : "memory"); }
+
+uint32_t cpu_save_and_disable_interrupts(void)
+{
+    uint32_t flags;
+
+    __asm__ volatile("pushf\n\t"
+                     "pop %0\n\t"
+                     "cli"
+                     : "=r"(flags)
+                     :
+                     : "memory");
+
+    return flags;
+}
+
+void cpu_restore_interrupts(uint32_t flags)
+{
+    if ((flags & CPU_EFLAGS_INTERRUPT_ENABLE) != 0) {
+        cpu_enable_interrupts();
+    }
+}
+
+/* Must be called with the interrupts disabled, returns with them enabled.
+ * There is no window between enabling the interrupts and waiting in which an
+ * interrupt would be missed.
+ */
+void cpu_wait_for_interrupt(void)
+{
+    if (cpu_mwait_supported) {
+        /* The CPU is woken up by an interrupt even though they are disabled.
+         * The interrupt is then handled after STI.
+         */
+        __asm__ volatile("monitor"
+                         :
+                         : "a"(&cpu_monitor_line), "c"(0), "d"(0));
+        __asm__ volatile("mwait\n\t"
+                         "sti\n\t"
+                         "nop"
+                         :
+                         : "a"(0), "c"(CPU_MWAIT_ECX_INTERRUPT_BREAK)
+                         : "memory");
+    } else {
+        /* The instruction following STI is executed before interrupts are
+         * recognized, so an interrupt arriving between the two instructions
+         * still wakes the CPU from HLT.
+         */
+        __asm__ volatile("sti\n\t"
+                         "hlt"
+                         :
+                         :
+                         : "memory");
+    }
+}
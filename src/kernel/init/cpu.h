@@ -0,0 +1,45 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CPU_CPUID_LEAF_MAX 0x00
+#define CPU_CPUID_LEAF_FEATURES 0x01
+#define CPU_CPUID_LEAF_MONITOR 0x05
+
+#define CPU_CPUID_FEATURES_ECX_MONITOR (1U << 3)
+
+#define CPU_CPUID_FEATURES_EDX_TSC (1U << 4)
+#define CPU_CPUID_FEATURES_EDX_MSR (1U << 5)
+#define CPU_CPUID_FEATURES_EDX_APIC (1U << 9)
+
+#define CPU_CPUID_MONITOR_ECX_INTERRUPT_BREAK (1U << 1)
+
+struct cpu_cpuid_result {
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+};
+
+void cpu_initialize(void);
+
+void cpu_cpuid(uint32_t leaf, struct cpu_cpuid_result *const result);
+
+uint32_t cpu_read_cr0(void);
+uint32_t cpu_read_cr2(void);
+uint32_t cpu_read_cr3(void);
+uint32_t cpu_read_cr4(void);
+
+uint64_t cpu_read_tsc(void);
+uint64_t cpu_read_msr(uint32_t msr);
+void cpu_write_msr(uint32_t msr, uint64_t value);
+
+void cpu_enable_interrupts(void);
+void cpu_disable_interrupts(void);
+uint32_t cpu_save_and_disable_interrupts(void);
+void cpu_restore_interrupts(uint32_t flags);
+void cpu_wait_for_interrupt(void);
+
+#endif
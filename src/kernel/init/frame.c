@@ -0,0 +1,99 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frame.h"
+#include "multiboot.h"
+
+// Memory below 1 MiB is used by the bootloader and the kernel init image
+#define FRAME_LOWEST_ADDRESS 0x100000ULL
+// Paging is not enabled, only the 32-bit physical address space is usable
+#define FRAME_ADDRESS_SPACE_END 0x100000000ULL
+
+struct frame_region {
+    uint32_t next;
+    uint32_t end;
+};
+
+static struct frame_region frame_regions[MULTIBOOT_MEMORY_MAP_MAX_ENTRIES];
+static uint32_t frame_region_count;
+static uint32_t frame_current_region;
+// Freed frames are linked through their first bytes
+static void *frame_free_list;
+
+static uint64_t frame_align_up(uint64_t address)
+{
+    return (address + FRAME_SIZE - 1) & ~((uint64_t)FRAME_SIZE - 1);
+}
+
+static uint64_t frame_align_down(uint64_t address)
+{
+    return address & ~((uint64_t)FRAME_SIZE - 1);
+}
+
+void frame_allocator_initialize(void)
+{
+    struct multiboot_memory_map_entry map[MULTIBOOT_MEMORY_MAP_MAX_ENTRIES];
+    const uint32_t count = multiboot_get_memory_map(map);
+
+    frame_region_count = 0;
+    frame_current_region = 0;
+    frame_free_list = NULL;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (map[i].type != MULTIBOOT_MEMORY_TYPE_AVAILABLE) {
+            continue;
+        }
+
+        const uint64_t base =
+            (((uint64_t)map[i].base_addr_high) << 32) | map[i].base_addr_low;
+        const uint64_t length =
+            (((uint64_t)map[i].length_high) << 32) | map[i].length_low;
+        uint64_t start = frame_align_up(base);
+        uint64_t end = frame_align_down(base + length);
+
+        if (start < FRAME_LOWEST_ADDRESS) {
+            start = FRAME_LOWEST_ADDRESS;
+        }
+        if (end > FRAME_ADDRESS_SPACE_END) {
+            end = FRAME_ADDRESS_SPACE_END;
+        }
+        if (start >= end) {
+            continue;
+        }
+
+        // The end of the last usable region may be 4 GiB, store it inclusive
+        frame_regions[frame_region_count].next = (uint32_t)start;
+        frame_regions[frame_region_count].end = (uint32_t)(end - 1);
+        ++frame_region_count;
+    }
+}
+
+void *frame_alloc(void)
+{
+    if (frame_free_list != NULL) {
+        void *const frame = frame_free_list;
+        frame_free_list = *(void **)frame;
+        return frame;
+    }
+
+    while (frame_current_region < frame_region_count) {
+        struct frame_region *const region =
+            &frame_regions[frame_current_region];
+
+        // The next address wraps around to zero after the frame below 4 GiB
+        if ((region->next != 0) && (region->next <= region->end)) {
+            void *const frame = (void *)region->next;
+            region->next += FRAME_SIZE;
+            return frame;
+        }
+        ++frame_current_region;
+    }
+
+    return NULL;
+}
+
+void frame_free(void *const frame)
+{
+    *(void **)frame = frame_free_list;
+    frame_free_list = frame;
+}
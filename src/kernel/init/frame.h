@@ -0,0 +1,12 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+#define FRAME_SIZE 4096
+
+void frame_allocator_initialize(void);
+void *frame_alloc(void);
+void frame_free(void *const frame);
+
+#endif
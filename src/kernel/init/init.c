@@ -8,9 +8,19 @@
 #include <stdint.h>
 
 #include "assert.h"
+#include "benchmark.h"
+#include "clock.h"
+#include "cpu.h"
+#include "frame.h"
+#include "interrupt.h"
+#include "lapic.h"
 #include "multiboot.h"
 #include "pci.h"
+#include "pci_ids.h"
+#include "self_test.h"
+#include "task.h"
 #include "terminal.h"
+#include "timer.h"
 
 /* Check if the compiler thinks you are targeting the wrong operating system. */
 #if defined(__linux__)
@@ -25,8 +35,11 @@
 
 #define USB_CONTROLLER_PCI_VENDOR_ID 0x8086
 #define USB_CONTROLLER_PCI_DEVICE_ID 0x24cd
-#define USB_CONTROLLER_NAME                                                    \
-    "Intel 82801DB/DBM (ICH4/ICH4-M) USB2 EHCI Controller"
+
+struct usb_controller_pci_function {
+    struct pci_function_address address;
+    struct pci_header_common header;
+};
 
 static void print_pci_device_list_header(void)
 {
@@ -35,6 +48,11 @@ static void print_pci_device_list_header(void)
     terminal_printf("  VendorID   DeviceID   Class      Subclass   ProgIF\n");
 }
 
+static const char *pci_id_name_or_unknown(const char *const name)
+{
+    return (name != NULL) ? name : "unknown";
+}
+
 static void
 print_pci_header_common(const struct pci_header_common *const pci_header)
 {
@@ -43,59 +61,118 @@ print_pci_header_common(const struct pci_header_common *const pci_header)
     terminal_printf(" %x", pci_header->class_code);
     terminal_printf(" %x", pci_header->subclass);
     terminal_printf(" %x\n", pci_header->prog_if);
+
+    // Names from the PCI ID database
+    terminal_printf(
+        "    %s: %s\n",
+        pci_id_name_or_unknown(pci_ids_vendor_name(pci_header->vendor_id)),
+        pci_id_name_or_unknown(pci_ids_device_name(pci_header->vendor_id,
+                                                   pci_header->device_id)));
+    terminal_printf(
+        "    %s: %s",
+        pci_id_name_or_unknown(pci_ids_class_name(pci_header->class_code)),
+        pci_id_name_or_unknown(pci_ids_subclass_name(pci_header->class_code,
+                                                     pci_header->subclass)));
+    // Most of the subclasses have no named programming interfaces
+    const char *const prog_if_name = pci_ids_prog_if_name(
+        pci_header->class_code, pci_header->subclass, pci_header->prog_if);
+    if (prog_if_name != NULL) {
+        terminal_printf(": %s", prog_if_name);
+    }
+    terminal_printf("\n");
 }
 
 static void
 print_usb_controller_info(const struct pci_function_address *const addr)
 {
     terminal_printf("Found USB controller:\n");
-    terminal_printf("  name: %s\n", USB_CONTROLLER_NAME);
+    terminal_printf("  name: %s\n",
+                    pci_id_name_or_unknown(
+                        pci_ids_device_name(USB_CONTROLLER_PCI_VENDOR_ID,
+                                            USB_CONTROLLER_PCI_DEVICE_ID)));
     terminal_printf("  PCI:  bus=%x  device=%x  function=%x\n",
                     addr->bus_number, addr->device_number,
                     addr->function_number);
 }
 
-// cppcheck-suppress unusedFunction
-void kernel_main(void)
+// Print out list of PCI functions and find the USB controller
+static void probe_pci_functions(void *arg)
 {
-    terminal_initialize();
-
-    multiboot_print_memory_map();
+    struct usb_controller_pci_function *const usb_controller =
+        (struct usb_controller_pci_function *)arg;
 
-    // Print out list of PCI functions and find the USB controller
     print_pci_device_list_header();
 
     struct pci_function_address pci_address;
     struct pci_header_common pci_header;
 
-    struct pci_function_address usb_controller_pci_address;
-    struct pci_header_common usb_controller_pci_header;
-
-    // Suppress compiler warning about uninitialized variable
-    usb_controller_pci_address.bus_number = 0;
-    usb_controller_pci_header.vendor_id = PCI_INVALID_VENDOR_ID;
-
     pci_function_iterator_init(&pci_address, &pci_header);
     while (pci_function_iterator_next(&pci_address, &pci_header)) {
         print_pci_header_common(&pci_header);
         if ((pci_header.vendor_id == USB_CONTROLLER_PCI_VENDOR_ID) &&
             (pci_header.device_id == USB_CONTROLLER_PCI_DEVICE_ID)) {
-            usb_controller_pci_address = pci_address;
-            usb_controller_pci_header = pci_header;
+            usb_controller->address = pci_address;
+            usb_controller->header = pci_header;
         }
     }
     terminal_printf("\n");
+}
+
+// cppcheck-suppress unusedFunction
+void kernel_main(void)
+{
+    terminal_initialize();
+
+    multiboot_print_memory_map();
+
+    cpu_initialize();
+    interrupt_initialize();
+    lapic_initialize();
+    clock_initialize();
+    timer_initialize();
+    cpu_enable_interrupts();
+
+    frame_allocator_initialize();
+    task_initialize();
+
+    terminal_printf("\n");
+    terminal_printf("TSC frequency: %u kHz\n", clock_get_tsc_khz());
+    terminal_printf("LAPIC timer frequency: %u kHz\n",
+                    clock_get_lapic_timer_khz());
 
-    ASSERT(
-        (usb_controller_pci_header.vendor_id == USB_CONTROLLER_PCI_VENDOR_ID) &&
-            (usb_controller_pci_header.device_id ==
-             USB_CONTROLLER_PCI_DEVICE_ID),
-        "USB controller not found");
+    struct usb_controller_pci_function usb_controller;
 
-    print_usb_controller_info(&usb_controller_pci_address);
+    // Suppress compiler warning about uninitialized variable
+    usb_controller.address.bus_number = 0;
+    usb_controller.header.vendor_id = PCI_INVALID_VENDOR_ID;
+
+    /* Nothing else runs during the probing yet. The task is a place where the
+     * initialization of other devices can overlap with it later.
+     */
+    struct task *const pci_probe_task =
+        task_create("pci probe", probe_pci_functions, &usb_controller);
+    ASSERT(pci_probe_task != NULL, "Cannot create PCI probe task");
+    task_join(pci_probe_task);
+
+    ASSERT((usb_controller.header.vendor_id == USB_CONTROLLER_PCI_VENDOR_ID) &&
+               (usb_controller.header.device_id ==
+                USB_CONTROLLER_PCI_DEVICE_ID),
+           "USB controller not found");
+
+    print_usb_controller_info(&usb_controller.address);
 
     for (uint8_t i = 0; i < PCI_BASE_ADDRESS_REGISTER_COUNT; ++i) {
         terminal_printf("  BAR register %d: %x\n", i,
-                        pci_read_bar_register(&usb_controller_pci_address, i));
+                        pci_read_bar_register(&usb_controller.address, i));
     }
+
+    task_print_statistics();
+
+#ifdef SELF_TEST
+    self_test_run();
+#endif
+
+#ifdef BENCHMARK
+    benchmark_run();
+#endif
 }
@@ -0,0 +1,129 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "interrupt.h"
+#include "io_port.h"
+#include "panic.h"
+
+#define INTERRUPT_CODE_SEGMENT_SELECTOR 0x08
+
+// Present, ring 0, 32-bit interrupt gate
+#define INTERRUPT_GATE_TYPE_ATTRIBUTES 0x8E
+
+#define PIC_MASTER_IO_COMMAND 0x20
+#define PIC_MASTER_IO_DATA 0x21
+#define PIC_SLAVE_IO_COMMAND 0xA0
+#define PIC_SLAVE_IO_DATA 0xA1
+
+#define PIC_MASTER_VECTOR_OFFSET 0x20
+#define PIC_SLAVE_VECTOR_OFFSET 0x28
+
+#define PIC_ICW1_INIT_WITH_ICW4 0x11
+#define PIC_ICW3_MASTER_SLAVE_AT_IRQ2 0x04
+#define PIC_ICW3_SLAVE_CASCADE_IDENTITY 0x02
+#define PIC_ICW4_8086_MODE 0x01
+#define PIC_MASK_ALL 0xFF
+
+struct __attribute__((packed)) interrupt_gate_descriptor {
+    uint16_t offset_low;
+    uint16_t segment_selector;
+    uint8_t reserved;
+    uint8_t type_attributes;
+    uint16_t offset_high;
+};
+
+struct __attribute__((packed)) interrupt_descriptor_table_register {
+    uint16_t limit;
+    uint32_t base;
+};
+
+// Entry points defined in isr.asm
+extern void (*const isr_exception_table[INTERRUPT_EXCEPTION_COUNT])(void);
+void isr_lapic_timer(void);
+void isr_panic(void);
+void isr_spurious(void);
+
+void interrupt_dispatch(struct interrupt_frame *const frame);
+
+static struct interrupt_gate_descriptor
+    interrupt_descriptor_table[INTERRUPT_VECTOR_COUNT];
+static interrupt_handler_t interrupt_handlers[INTERRUPT_VECTOR_COUNT];
+/* Cleared with .bss in boot.asm. Until it is set, panic() must not raise the
+ * panic interrupt because no IDT is loaded.
+ */
+static bool interrupt_initialized;
+
+static void interrupt_set_gate(uint8_t vector, void (*entry)(void))
+{
+    struct interrupt_gate_descriptor *const gate =
+        &interrupt_descriptor_table[vector];
+    const uint32_t offset = (uint32_t)entry;
+
+    gate->offset_low = (uint16_t)offset;
+    gate->segment_selector = INTERRUPT_CODE_SEGMENT_SELECTOR;
+    gate->reserved = 0;
+    gate->type_attributes = INTERRUPT_GATE_TYPE_ATTRIBUTES;
+    gate->offset_high = (uint16_t)(offset >> 16);
+}
+
+/* The legacy PICs are not used, the local APIC is. Their default vectors
+ * overlap with the CPU exceptions, so they are moved out of the way before
+ * masking all their inputs.
+ */
+static void interrupt_disable_pic(void)
+{
+    io_port_out_byte(PIC_MASTER_IO_COMMAND, PIC_ICW1_INIT_WITH_ICW4);
+    io_port_out_byte(PIC_SLAVE_IO_COMMAND, PIC_ICW1_INIT_WITH_ICW4);
+    io_port_out_byte(PIC_MASTER_IO_DATA, PIC_MASTER_VECTOR_OFFSET);
+    io_port_out_byte(PIC_SLAVE_IO_DATA, PIC_SLAVE_VECTOR_OFFSET);
+    io_port_out_byte(PIC_MASTER_IO_DATA, PIC_ICW3_MASTER_SLAVE_AT_IRQ2);
+    io_port_out_byte(PIC_SLAVE_IO_DATA, PIC_ICW3_SLAVE_CASCADE_IDENTITY);
+    io_port_out_byte(PIC_MASTER_IO_DATA, PIC_ICW4_8086_MODE);
+    io_port_out_byte(PIC_SLAVE_IO_DATA, PIC_ICW4_8086_MODE);
+
+    io_port_out_byte(PIC_MASTER_IO_DATA, PIC_MASK_ALL);
+    io_port_out_byte(PIC_SLAVE_IO_DATA, PIC_MASK_ALL);
+}
+
+// Called only from isr.asm
+// cppcheck-suppress unusedFunction
+void interrupt_dispatch(struct interrupt_frame *const frame)
+{
+    const interrupt_handler_t handler = interrupt_handlers[frame->vector];
+
+    if (handler != NULL) {
+        handler(frame);
+    } else if ((frame->vector < INTERRUPT_EXCEPTION_COUNT) ||
+               (frame->vector == INTERRUPT_VECTOR_PANIC)) {
+        panic_interrupt(frame);
+    }
+}
+
+void interrupt_initialize(void)
+{
+    interrupt_disable_pic();
+
+    for (uint8_t i = 0; i < INTERRUPT_EXCEPTION_COUNT; ++i) {
+        interrupt_set_gate(i, isr_exception_table[i]);
+    }
+    interrupt_set_gate(INTERRUPT_VECTOR_LAPIC_TIMER, isr_lapic_timer);
+    interrupt_set_gate(INTERRUPT_VECTOR_PANIC, isr_panic);
+    interrupt_set_gate(INTERRUPT_VECTOR_SPURIOUS, isr_spurious);
+
+    const struct interrupt_descriptor_table_register idtr = {
+        .limit = sizeof(interrupt_descriptor_table) - 1,
+        .base = (uint32_t)interrupt_descriptor_table,
+    };
+
+    __asm__ volatile("lidt %0" : : "m"(idtr));
+
+    interrupt_initialized = true;
+}
+
+bool interrupt_is_initialized(void) { return interrupt_initialized; }
+
+void interrupt_set_handler(uint8_t vector, interrupt_handler_t handler)
+{
+    interrupt_handlers[vector] = handler;
+}
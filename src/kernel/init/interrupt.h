@@ -0,0 +1,40 @@
+#ifndef INTERRUPT_H
+#define INTERRUPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INTERRUPT_VECTOR_COUNT 256
+#define INTERRUPT_EXCEPTION_COUNT 32
+
+#define INTERRUPT_VECTOR_LAPIC_TIMER 0x40
+#define INTERRUPT_VECTOR_PANIC 0x41
+#define INTERRUPT_VECTOR_SPURIOUS 0xFF
+
+/* Layout of the stack built by the common interrupt entry code in isr.asm */
+struct interrupt_frame {
+    // Pushed by PUSHAL
+    uint32_t edi;
+    uint32_t esi;
+    uint32_t ebp;
+    uint32_t esp;
+    uint32_t ebx;
+    uint32_t edx;
+    uint32_t ecx;
+    uint32_t eax;
+    // Pushed by the vector-specific entry code
+    uint32_t vector;
+    uint32_t error_code;
+    // Pushed by the CPU
+    uint32_t eip;
+    uint32_t cs;
+    uint32_t eflags;
+};
+
+typedef void (*interrupt_handler_t)(struct interrupt_frame *const frame);
+
+void interrupt_initialize(void);
+bool interrupt_is_initialized(void);
+void interrupt_set_handler(uint8_t vector, interrupt_handler_t handler);
+
+#endif
@@ -1,5 +1,23 @@
 #include "io_port.h"
 
+void io_port_out_byte(uint16_t port, uint8_t value)
+{
+    register uint16_t p __asm__("dx") = port;
+    register uint8_t v __asm__("al") = value;
+
+    __asm__("out %[value], %[port]" : : [ value ] "r"(v), [ port ] "r"(p));
+}
+
+uint8_t io_port_in_byte(uint16_t port)
+{
+    register uint16_t p __asm__("dx") = port;
+    register uint8_t v __asm__("al");
+
+    __asm__("in %[port], %[value]" : [ value ] "=r"(v) : [ port ] "r"(p));
+
+    return v;
+}
+
 void io_port_out_dword(uint16_t port, uint32_t value)
 {
     register uint16_t p __asm__("dx") = port;
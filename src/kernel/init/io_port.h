@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+void io_port_out_byte(uint16_t port, uint8_t value);
+uint8_t io_port_in_byte(uint16_t port);
 void io_port_out_dword(uint16_t port, uint32_t value);
 uint32_t io_port_in_dword(uint16_t port);
 
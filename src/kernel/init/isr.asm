@@ -0,0 +1,75 @@
+/*
+Entry points of the interrupt handlers. Each entry point pushes a dummy error
+code (if the CPU does not push one) and its vector number, so all of them can
+share the code that saves the registers and calls the C dispatcher. The
+resulting stack layout is described by struct interrupt_frame in interrupt.h.
+*/
+
+.macro ISR_NO_ERROR_CODE name, vector
+.global \name
+.type \name, @function
+\name:
+        pushl   $0
+        pushl   $\vector
+        jmp     isr_common
+.size \name, . - \name
+.endm
+
+.macro ISR_ERROR_CODE name, vector
+.global \name
+.type \name, @function
+\name:
+        pushl   $\vector
+        jmp     isr_common
+.size \name, . - \name
+.endm
+
+/* Exceptions 8, 10-14, 17, 21, 29 and 30 push an error code */
+.macro ISR_EXCEPTION vector
+.if (\vector == 8) || ((\vector >= 10) && (\vector <= 14)) || (\vector == 17) || (\vector == 21) || (\vector == 29) || (\vector == 30)
+ISR_ERROR_CODE isr_exception_\vector, \vector
+.else
+ISR_NO_ERROR_CODE isr_exception_\vector, \vector
+.endif
+.endm
+
+.section .text
+
+.irp vector, 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31
+ISR_EXCEPTION \vector
+.endr
+
+ISR_NO_ERROR_CODE isr_lapic_timer, 0x40
+ISR_NO_ERROR_CODE isr_panic, 0x41
+
+isr_common:
+        pushal
+        /* The System V ABI requires the direction flag to be clear */
+        cld
+        /* Pass a pointer to the struct interrupt_frame */
+        pushl   %esp
+        call    interrupt_dispatch
+        addl    $4, %esp
+        popal
+        /* Remove the vector number and the error code */
+        addl    $8, %esp
+        iret
+
+/*
+The local APIC does not expect an EOI for a spurious interrupt, so there is
+nothing to do.
+*/
+.global isr_spurious
+.type isr_spurious, @function
+isr_spurious:
+        iret
+.size isr_spurious, . - isr_spurious
+
+/* Entry points of the exception handlers indexed by the vector number */
+.section .rodata
+.align 4
+.global isr_exception_table
+isr_exception_table:
+.irp vector, 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31
+        .long   isr_exception_\vector
+.endr
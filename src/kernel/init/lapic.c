@@ -0,0 +1,101 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "assert.h"
+#include "cpu.h"
+#include "interrupt.h"
+#include "lapic.h"
+
+#define LAPIC_MSR_APIC_BASE 0x1B
+#define LAPIC_MSR_APIC_BASE_ENABLE (1U << 11)
+#define LAPIC_MSR_APIC_BASE_ADDRESS_MASK 0xFFFFF000
+
+#define LAPIC_REG_EOI 0x0B0
+#define LAPIC_REG_SPURIOUS_VECTOR 0x0F0
+#define LAPIC_REG_INTERRUPT_COMMAND_LOW 0x300
+#define LAPIC_REG_INTERRUPT_COMMAND_HIGH 0x310
+#define LAPIC_REG_LVT_TIMER 0x320
+#define LAPIC_REG_TIMER_INITIAL_COUNT 0x380
+#define LAPIC_REG_TIMER_CURRENT_COUNT 0x390
+#define LAPIC_REG_TIMER_DIVIDE_CONFIG 0x3E0
+
+#define LAPIC_SPURIOUS_VECTOR_APIC_ENABLE (1U << 8)
+#define LAPIC_LVT_MASKED (1U << 16)
+#define LAPIC_LVT_TIMER_MODE_ONE_SHOT (0U << 17)
+#define LAPIC_TIMER_DIVIDE_BY_16 0x03
+
+#define LAPIC_ICR_DELIVERY_MODE_NMI (4U << 8)
+#define LAPIC_ICR_DELIVERY_STATUS_PENDING (1U << 12)
+#define LAPIC_ICR_LEVEL_ASSERT (1U << 14)
+#define LAPIC_ICR_DESTINATION_ALL_EXCLUDING_SELF (3U << 18)
+
+static volatile uint32_t *lapic_registers;
+
+static uint32_t lapic_read(uint32_t reg)
+{
+    return lapic_registers[reg / sizeof(uint32_t)];
+}
+
+static void lapic_write(uint32_t reg, uint32_t value)
+{
+    lapic_registers[reg / sizeof(uint32_t)] = value;
+}
+
+void lapic_initialize(void)
+{
+    struct cpu_cpuid_result features;
+
+    cpu_cpuid(CPU_CPUID_LEAF_FEATURES, &features);
+    ASSERT((features.edx & CPU_CPUID_FEATURES_EDX_APIC) != 0,
+           "Local APIC not present");
+    ASSERT((features.edx & CPU_CPUID_FEATURES_EDX_MSR) != 0,
+           "MSRs not supported");
+
+    uint64_t base = cpu_read_msr(LAPIC_MSR_APIC_BASE);
+    base |= LAPIC_MSR_APIC_BASE_ENABLE;
+    cpu_write_msr(LAPIC_MSR_APIC_BASE, base);
+
+    lapic_registers =
+        (volatile uint32_t *)((uint32_t)base &
+                              LAPIC_MSR_APIC_BASE_ADDRESS_MASK);
+
+    lapic_write(LAPIC_REG_SPURIOUS_VECTOR, LAPIC_SPURIOUS_VECTOR_APIC_ENABLE |
+                                               INTERRUPT_VECTOR_SPURIOUS);
+
+    lapic_write(LAPIC_REG_TIMER_DIVIDE_CONFIG, LAPIC_TIMER_DIVIDE_BY_16);
+    lapic_write(LAPIC_REG_LVT_TIMER, LAPIC_LVT_TIMER_MODE_ONE_SHOT |
+                                         INTERRUPT_VECTOR_LAPIC_TIMER);
+    lapic_timer_stop();
+}
+
+void lapic_end_of_interrupt(void) { lapic_write(LAPIC_REG_EOI, 0); }
+
+void lapic_send_nmi_to_others(void)
+{
+    // Other CPUs could not have been started without the local APIC
+    if (lapic_registers == NULL) {
+        return;
+    }
+
+    lapic_write(LAPIC_REG_INTERRUPT_COMMAND_HIGH, 0);
+    lapic_write(LAPIC_REG_INTERRUPT_COMMAND_LOW,
+                LAPIC_ICR_DESTINATION_ALL_EXCLUDING_SELF |
+                    LAPIC_ICR_LEVEL_ASSERT | LAPIC_ICR_DELIVERY_MODE_NMI);
+
+    while ((lapic_read(LAPIC_REG_INTERRUPT_COMMAND_LOW) &
+            LAPIC_ICR_DELIVERY_STATUS_PENDING) != 0) {
+        ;
+    }
+}
+
+void lapic_timer_start(uint32_t count)
+{
+    lapic_write(LAPIC_REG_TIMER_INITIAL_COUNT, count);
+}
+
+void lapic_timer_stop(void) { lapic_write(LAPIC_REG_TIMER_INITIAL_COUNT, 0); }
+
+uint32_t lapic_timer_read_count(void)
+{
+    return lapic_read(LAPIC_REG_TIMER_CURRENT_COUNT);
+}
@@ -0,0 +1,16 @@
+#ifndef LAPIC_H
+#define LAPIC_H
+
+#include <stdint.h>
+
+#define LAPIC_TIMER_MAX_COUNT 0xFFFFFFFF
+
+void lapic_initialize(void);
+void lapic_end_of_interrupt(void);
+void lapic_send_nmi_to_others(void);
+
+void lapic_timer_start(uint32_t count);
+void lapic_timer_stop(void);
+uint32_t lapic_timer_read_count(void);
+
+#endif
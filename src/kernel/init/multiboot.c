@@ -21,18 +21,40 @@ struct multiboot_mmap_entry {
     uint32_t type;
 };
 
+// Saved from EBX by the entry code in boot.asm
+extern uint32_t multiboot_info_struct_address;
+
 static uint32_t multiboot_get_info_struct_addr(void)
 {
-    uint32_t a;
-    /* Bootloader passed an address of the multiboot information structure in
-     * EBX.
-     */
-    __asm__("mov %%ebx, %0" : "=g"(a));
-
-    return a;
+    return multiboot_info_struct_address;
 }
 
-void multiboot_get_memory_map(void) { ; }
+uint32_t
+multiboot_get_memory_map(struct multiboot_memory_map_entry *const entries)
+{
+    struct __attribute__((packed)) multiboot_info_struct *info_struct =
+        (struct multiboot_info_struct *)multiboot_get_info_struct_addr();
+
+    uint32_t count = 0;
+    uint32_t l = 0;
+    while ((l < info_struct->mmap_length) &&
+           (count < MULTIBOOT_MEMORY_MAP_MAX_ENTRIES)) {
+        struct __attribute__((packed)) multiboot_mmap_entry *me =
+            (struct multiboot_mmap_entry *)(info_struct->mmap_addr + l);
+
+        entries[count].base_addr_low = me->base_addr_low;
+        entries[count].base_addr_high = me->base_addr_high;
+        entries[count].length_low = me->length_low;
+        entries[count].length_high = me->length_high;
+        entries[count].type = me->type;
+        entries[count].extended_attributes = 0;
+        ++count;
+
+        l += me->entry_size;
+    }
+
+    return count;
+}
 
 void multiboot_print_memory_map(void)
 {
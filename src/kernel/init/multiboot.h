@@ -1,8 +1,12 @@
 #ifndef MULTIBOOT_H
 #define MULTIBOOT_H
 
+#include <stdint.h>
+
 #define MULTIBOOT_MEMORY_MAP_MAX_ENTRIES 32
 
+#define MULTIBOOT_MEMORY_TYPE_AVAILABLE 1
+
 struct multiboot_memory_map_entry {
     uint32_t base_addr_low;
     uint32_t base_addr_high;
@@ -12,7 +16,8 @@ struct multiboot_memory_map_entry {
     uint32_t extended_attributes;
 };
 
-void multiboot_get_memory_map(void);
+uint32_t
+multiboot_get_memory_map(struct multiboot_memory_map_entry *const entries);
 void multiboot_print_memory_map(void);
 
 #endif
@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpu.h"
+#include "interrupt.h"
+#include "io_port.h"
+#include "lapic.h"
+#include "panic.h"
+#include "qemu_debug_exit.h"
+#include "terminal.h"
+
+#define PANIC_BACKTRACE_MAX_DEPTH 16
+
+// False from the start, boot.asm zeroes .bss before kernel_main
+static volatile bool panic_in_progress;
+static const char *panic_file;
+static uint32_t panic_line;
+static const char *panic_message;
+
+static void panic_halt(void) __attribute__((noreturn));
+
+static void panic_halt(void)
+{
+#ifdef QEMU_DEBUG_EXIT
+    io_port_out_byte(QEMU_DEBUG_EXIT_IO_PORT, QEMU_DEBUG_EXIT_FAILURE);
+#endif
+
+    // HLT can be left because of an NMI or a system management interrupt
+    for (;;) {
+        __asm__ volatile("cli\n\t"
+                         "hlt");
+    }
+}
+
+static void panic_print_registers(const struct interrupt_frame *const frame)
+{
+    // The CPU does not push ESP when the interrupted code runs in ring 0
+    const uint32_t esp = (uint32_t)&frame->eflags + sizeof(frame->eflags);
+
+    terminal_printf("  EAX=%x  EBX=%x  ECX=%x  EDX=%x\n", frame->eax,
+                    frame->ebx, frame->ecx, frame->edx);
+    terminal_printf("  ESI=%x  EDI=%x  EBP=%x  ESP=%x\n", frame->esi,
+                    frame->edi, frame->ebp, esp);
+    terminal_printf("  EIP=%x  CS=%x   EFLAGS=%x\n", frame->eip, frame->cs,
+                    frame->eflags);
+    terminal_printf("  CR0=%x  CR2=%x  CR3=%x  CR4=%x\n", cpu_read_cr0(),
+                    cpu_read_cr2(), cpu_read_cr3(), cpu_read_cr4());
+}
+
+/* Walk the chain of the saved frame pointers. It ends with the zero frame
+ * pointer set up at the entry of the kernel and of each task.
+ */
+static void panic_print_backtrace(uint32_t eip, uint32_t ebp)
+{
+    terminal_printf("Backtrace:\n");
+    if (eip != 0) {
+        terminal_printf("  %x\n", eip);
+    }
+
+    for (uint8_t i = 0; i < PANIC_BACKTRACE_MAX_DEPTH; ++i) {
+        if ((ebp == 0) || ((ebp % sizeof(uint32_t)) != 0)) {
+            break;
+        }
+
+        const uint32_t *const stack_frame = (const uint32_t *)ebp;
+        const uint32_t return_address = stack_frame[1];
+
+        if (return_address == 0) {
+            break;
+        }
+        terminal_printf("  %x\n", return_address);
+
+        // Frames of the callers are at higher addresses
+        if (stack_frame[0] <= ebp) {
+            break;
+        }
+        ebp = stack_frame[0];
+    }
+}
+
+static void panic_stop(void) __attribute__((noreturn));
+
+static void panic_stop(void)
+{
+    lapic_send_nmi_to_others();
+    panic_halt();
+}
+
+void panic(const char *const file, uint32_t line, const char *const message)
+{
+    cpu_disable_interrupts();
+
+    panic_file = file;
+    panic_line = line;
+    panic_message = message;
+
+    if (interrupt_is_initialized()) {
+        // Let the interrupt entry code capture the registers
+        __asm__ volatile("int %0" : : "i"(INTERRUPT_VECTOR_PANIC));
+    }
+
+    // Too early for the interrupts, there are no registers to print
+    if (!panic_in_progress) {
+        panic_in_progress = true;
+        terminal_printf("\n");
+        terminal_printf("KERNEL PANIC: %s\n", panic_message);
+        terminal_printf("  at %s:%u\n", panic_file, panic_line);
+        panic_print_backtrace(0, (uint32_t)__builtin_frame_address(0));
+    }
+
+    panic_stop();
+}
+
+void panic_interrupt(const struct interrupt_frame *const frame)
+{
+    /* Either a nested panic, or another CPU has panicked and sent an NMI to
+     * stop this one.
+     */
+    if (panic_in_progress) {
+        panic_halt();
+    }
+    panic_in_progress = true;
+
+    terminal_printf("\n");
+    if (frame->vector == INTERRUPT_VECTOR_PANIC) {
+        terminal_printf("KERNEL PANIC: %s\n", panic_message);
+        terminal_printf("  at %s:%u\n", panic_file, panic_line);
+    } else {
+        terminal_printf("KERNEL PANIC: exception %u, error code %x\n",
+                        frame->vector, frame->error_code);
+    }
+
+    panic_print_registers(frame);
+    panic_print_backtrace(frame->eip, frame->ebp);
+
+    panic_stop();
+}
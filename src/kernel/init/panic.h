@@ -0,0 +1,13 @@
+#ifndef PANIC_H
+#define PANIC_H
+
+#include <stdint.h>
+
+#include "interrupt.h"
+
+void panic(const char *const file, uint32_t line, const char *const message)
+    __attribute__((noreturn));
+void panic_interrupt(const struct interrupt_frame *const frame)
+    __attribute__((noreturn));
+
+#endif
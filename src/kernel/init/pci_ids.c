@@ -0,0 +1,56 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pci_ids.h"
+#include "pci_ids_hash.h"
+#include "pci_ids_table.h"
+
+static const char *pci_ids_lookup(const struct pci_ids_table *const table,
+                                  uint32_t key)
+{
+    if (table->entry_count == 0) {
+        return NULL;
+    }
+
+    const uint32_t bucket =
+        pci_ids_hash_bucket(key, table->seed, table->bucket_count);
+    const uint32_t slot =
+        pci_ids_hash_slot(key, table->seed, table->displacements[bucket],
+                          table->entry_count);
+
+    // A key which is not in the table is hashed to a slot of another key
+    if (table->keys[slot] != key) {
+        return NULL;
+    }
+
+    return &pci_ids_string_pool[table->name_offsets[slot]];
+}
+
+const char *pci_ids_vendor_name(uint16_t vendor_id)
+{
+    return pci_ids_lookup(&pci_ids_vendors, PCI_IDS_VENDOR_KEY(vendor_id));
+}
+
+const char *pci_ids_device_name(uint16_t vendor_id, uint16_t device_id)
+{
+    return pci_ids_lookup(&pci_ids_devices,
+                          PCI_IDS_DEVICE_KEY(vendor_id, device_id));
+}
+
+const char *pci_ids_class_name(uint8_t class_code)
+{
+    return pci_ids_lookup(&pci_ids_classes, PCI_IDS_CLASS_KEY(class_code));
+}
+
+const char *pci_ids_subclass_name(uint8_t class_code, uint8_t subclass)
+{
+    return pci_ids_lookup(&pci_ids_classes,
+                          PCI_IDS_SUBCLASS_KEY(class_code, subclass));
+}
+
+const char *pci_ids_prog_if_name(uint8_t class_code, uint8_t subclass,
+                                 uint8_t prog_if)
+{
+    return pci_ids_lookup(&pci_ids_classes,
+                          PCI_IDS_PROG_IF_KEY(class_code, subclass, prog_if));
+}
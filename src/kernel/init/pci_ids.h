@@ -0,0 +1,16 @@
+#ifndef PCI_IDS_H
+#define PCI_IDS_H
+
+#include <stdint.h>
+
+/* Human-readable names of the PCI IDs. NULL is returned for an ID that is not
+ * in the database.
+ */
+const char *pci_ids_vendor_name(uint16_t vendor_id);
+const char *pci_ids_device_name(uint16_t vendor_id, uint16_t device_id);
+const char *pci_ids_class_name(uint8_t class_code);
+const char *pci_ids_subclass_name(uint8_t class_code, uint8_t subclass);
+const char *pci_ids_prog_if_name(uint8_t class_code, uint8_t subclass,
+                                 uint8_t prog_if);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef PCI_IDS_HASH_H
+#define PCI_IDS_HASH_H
+
+/* Hash functions of the PCI ID name tables
+ *
+ * This file is shared by the kernel and by the generator of the tables
+ * (tools/pci_ids_generator.c), which runs on the build machine. Both must
+ * compute the same values.
+ *
+ * A table of N entries is a minimal perfect hash built by the hash and
+ * displace method. A key is first hashed into one of the buckets. The
+ * displacement stored for the bucket selects a second hash function, which
+ * maps the key into one of the N slots. The generator chooses the
+ * displacements so no two keys end up in the same slot.
+ */
+
+#include <stdint.h>
+
+#define PCI_IDS_VENDOR_KEY(vendor_id) ((uint32_t)(vendor_id))
+#define PCI_IDS_DEVICE_KEY(vendor_id, device_id)                               \
+    ((((uint32_t)(vendor_id)) << 16) | ((uint32_t)(device_id)))
+
+// Classes, subclasses and programming interfaces share one table
+#define PCI_IDS_CLASS_KEY(class_code)                                          \
+    (0x01000000U | (((uint32_t)(class_code)) << 16))
+#define PCI_IDS_SUBCLASS_KEY(class_code, subclass)                             \
+    (0x02000000U | (((uint32_t)(class_code)) << 16) |                          \
+     (((uint32_t)(subclass)) << 8))
+#define PCI_IDS_PROG_IF_KEY(class_code, subclass, prog_if)                     \
+    (0x03000000U | (((uint32_t)(class_code)) << 16) |                          \
+     (((uint32_t)(subclass)) << 8) | ((uint32_t)(prog_if)))
+
+static inline uint32_t pci_ids_hash(uint32_t key, uint32_t seed)
+{
+    uint32_t h = (key ^ seed) * 0x9E3779B1U;
+
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+
+    return h;
+}
+
+// Map a hash to [0, range) without a division
+static inline uint32_t pci_ids_hash_reduce(uint32_t hash, uint32_t range)
+{
+    return (uint32_t)((((uint64_t)hash) * range) >> 32);
+}
+
+static inline uint32_t pci_ids_hash_bucket(uint32_t key, uint32_t seed,
+                                           uint32_t bucket_count)
+{
+    return pci_ids_hash_reduce(pci_ids_hash(key, seed), bucket_count);
+}
+
+static inline uint32_t pci_ids_hash_slot(uint32_t key, uint32_t seed,
+                                         uint16_t displacement,
+                                         uint32_t entry_count)
+{
+    const uint32_t slot_seed = seed + ((displacement + 1U) * 0x27D4EB2FU);
+
+    return pci_ids_hash_reduce(pci_ids_hash(key, slot_seed), entry_count);
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PCI_IDS_TABLE_H
+#define PCI_IDS_TABLE_H
+
+#include <stdint.h>
+
+/* Layout of the PCI ID name tables generated at build time from pci.ids by
+ * tools/pci_ids_generator.c. The names are offsets into a shared pool of
+ * null-terminated strings.
+ */
+struct pci_ids_table {
+    uint32_t seed;
+    uint16_t bucket_count;
+    uint16_t entry_count;
+    const uint16_t *displacements;
+    const uint32_t *keys;
+    const uint16_t *name_offsets;
+};
+
+extern const char pci_ids_string_pool[];
+
+extern const struct pci_ids_table pci_ids_vendors;
+extern const struct pci_ids_table pci_ids_devices;
+extern const struct pci_ids_table pci_ids_classes;
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef QEMU_DEBUG_EXIT_H
+#define QEMU_DEBUG_EXIT_H
+
+/* Port of the isa-debug-exit device. QEMU exits with status (value << 1) | 1
+ * when a value is written to it, so the status is 3 on a failure and 33 on a
+ * success.
+ */
+#define QEMU_DEBUG_EXIT_IO_PORT 0xF4
+#define QEMU_DEBUG_EXIT_FAILURE 0x01
+#define QEMU_DEBUG_EXIT_SUCCESS 0x10
+
+#endif
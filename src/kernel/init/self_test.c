@@ -0,0 +1,165 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "assert.h"
+#include "clock.h"
+#include "cpu.h"
+#include "io_port.h"
+#include "qemu_debug_exit.h"
+#include "self_test.h"
+#include "terminal.h"
+#include "timer.h"
+
+#define SELF_TEST_ORDER_TIMER_COUNT 3
+#define SELF_TEST_CANCELLED_DELAY_NS (100 * TIMER_TICK_NS)
+#define SELF_TEST_FAR_TIMER_COUNT 3
+#define SELF_TEST_REARM_COUNT 5
+#define SELF_TEST_REARM_DELAY_NS (2 * CLOCK_NS_PER_MS)
+// A timer lost by the timer wheel would otherwise be waited for forever
+#define SELF_TEST_TIMEOUT_NS (1000 * CLOCK_NS_PER_MS)
+
+struct self_test_timer {
+    struct timer timer;
+    uint64_t deadline_ns;
+    uint32_t fired_count;
+    uint32_t fired_order;
+};
+
+/* In level 0, past level 1 (64 ticks) and past level 2 (4096 ticks). They are
+ * armed from the latest to the earliest.
+ */
+static const uint64_t self_test_order_delays_ns[SELF_TEST_ORDER_TIMER_COUNT] =
+    {4100 * TIMER_TICK_NS, 70 * TIMER_TICK_NS,
+     5 * TIMER_TICK_NS};
+
+/* Beyond the reach of the wheel (about 4.9 h), and far enough to overflow a
+ * 32-bit tick. None of them may fire during the test.
+ */
+static const uint64_t self_test_far_delays_ns[SELF_TEST_FAR_TIMER_COUNT] = {
+    5ULL * 60 * 60 * 1000 * CLOCK_NS_PER_MS,
+    30ULL * 24 * 60 * 60 * 1000 * CLOCK_NS_PER_MS, UINT64_MAX};
+
+static struct self_test_timer self_test_timers[SELF_TEST_ORDER_TIMER_COUNT];
+static struct self_test_timer self_test_far_timers[SELF_TEST_FAR_TIMER_COUNT];
+static struct self_test_timer self_test_cancelled_timer;
+static struct self_test_timer self_test_rearmed_timer;
+static volatile uint32_t self_test_fired_count;
+
+static void self_test_timer_fired(struct self_test_timer *const t)
+{
+    ASSERT(ktime_ns() >= t->deadline_ns, "Timer expired early");
+
+    ++t->fired_count;
+    t->fired_order = self_test_fired_count;
+    ++self_test_fired_count;
+}
+
+static void self_test_timer_callback(void *arg)
+{
+    self_test_timer_fired((struct self_test_timer *)arg);
+}
+
+static void self_test_rearm_callback(void *arg)
+{
+    struct self_test_timer *const t = (struct self_test_timer *)arg;
+
+    self_test_timer_fired(t);
+    if (t->fired_count < SELF_TEST_REARM_COUNT) {
+        t->deadline_ns = ktime_ns() + SELF_TEST_REARM_DELAY_NS;
+        timer_arm(&t->timer, SELF_TEST_REARM_DELAY_NS,
+                  self_test_rearm_callback, t);
+    }
+}
+
+static void self_test_arm(struct self_test_timer *const t, uint64_t ns,
+                          timer_callback_t callback)
+{
+    t->deadline_ns = ktime_ns() + ns;
+    timer_arm(&t->timer, ns, callback, t);
+}
+
+static void self_test_wait_for_timers(uint32_t count, uint64_t ns)
+{
+    const uint64_t deadline_ns = ktime_ns() + ns + SELF_TEST_TIMEOUT_NS;
+
+    cpu_disable_interrupts();
+    while (self_test_fired_count < count) {
+        ASSERT(ktime_ns() < deadline_ns, "Timers not fired in time");
+        cpu_wait_for_interrupt();
+        cpu_disable_interrupts();
+    }
+    cpu_enable_interrupts();
+}
+
+static void self_test_timer_order(void)
+{
+    self_test_fired_count = 0;
+    for (uint8_t i = 0; i < SELF_TEST_ORDER_TIMER_COUNT; ++i) {
+        self_test_arm(&self_test_timers[i], self_test_order_delays_ns[i],
+                      self_test_timer_callback);
+    }
+    for (uint8_t i = 0; i < SELF_TEST_FAR_TIMER_COUNT; ++i) {
+        // Any call of the callback fails the check of an early expiration
+        self_test_far_timers[i].deadline_ns = UINT64_MAX;
+        timer_arm(&self_test_far_timers[i].timer, self_test_far_delays_ns[i],
+                  self_test_timer_callback, &self_test_far_timers[i]);
+    }
+    self_test_arm(&self_test_cancelled_timer, SELF_TEST_CANCELLED_DELAY_NS,
+                  self_test_timer_callback);
+    ASSERT(timer_cancel(&self_test_cancelled_timer.timer),
+           "Armed timer not cancelled");
+
+    self_test_wait_for_timers(SELF_TEST_ORDER_TIMER_COUNT,
+                              self_test_order_delays_ns[0]);
+
+    for (uint8_t i = 0; i < SELF_TEST_ORDER_TIMER_COUNT; ++i) {
+        const struct self_test_timer *const t = &self_test_timers[i];
+
+        ASSERT(t->fired_count == 1, "Timer not fired exactly once");
+        ASSERT(t->fired_order == (SELF_TEST_ORDER_TIMER_COUNT - 1U - i),
+               "Timers fired out of order");
+        ASSERT(!timer_is_armed(&t->timer), "Fired timer still armed");
+    }
+    // It would have expired before the last timer
+    ASSERT(self_test_cancelled_timer.fired_count == 0,
+           "Cancelled timer fired");
+    ASSERT(!timer_is_armed(&self_test_cancelled_timer.timer),
+           "Cancelled timer still armed");
+    ASSERT(!timer_cancel(&self_test_cancelled_timer.timer),
+           "Cancelled timer cancelled again");
+
+    for (uint8_t i = 0; i < SELF_TEST_FAR_TIMER_COUNT; ++i) {
+        struct self_test_timer *const t = &self_test_far_timers[i];
+
+        ASSERT(t->fired_count == 0, "Far timer fired early");
+        ASSERT(timer_cancel(&t->timer), "Far timer not armed");
+    }
+}
+
+static void self_test_timer_rearm(void)
+{
+    self_test_fired_count = 0;
+    self_test_arm(&self_test_rearmed_timer, SELF_TEST_REARM_DELAY_NS,
+                  self_test_rearm_callback);
+
+    self_test_wait_for_timers(SELF_TEST_REARM_COUNT,
+                              SELF_TEST_REARM_COUNT * SELF_TEST_REARM_DELAY_NS);
+
+    ASSERT(self_test_rearmed_timer.fired_count == SELF_TEST_REARM_COUNT,
+           "Re-armed timer fired wrong number of times");
+    ASSERT(!timer_is_armed(&self_test_rearmed_timer.timer),
+           "Re-armed timer still armed");
+}
+
+void self_test_run(void)
+{
+    terminal_printf("\n");
+    terminal_printf("Timer self-test (takes about 5 s): ");
+    self_test_timer_order();
+    self_test_timer_rearm();
+    terminal_printf("passed\n");
+
+    // A failed check exits QEMU from panic()
+    io_port_out_byte(QEMU_DEBUG_EXIT_IO_PORT, QEMU_DEBUG_EXIT_SUCCESS);
+}
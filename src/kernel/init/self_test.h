@@ -0,0 +1,7 @@
+#ifndef SELF_TEST_H
+#define SELF_TEST_H
+
+// Checks of the kernel subsystems. A failed check ends in a kernel panic.
+void self_test_run(void);
+
+#endif
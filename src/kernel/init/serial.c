@@ -0,0 +1,78 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "io_port.h"
+#include "serial.h"
+
+#define SERIAL_COM1_IO_BASE 0x3F8
+
+#define SERIAL_REG_DATA 0
+#define SERIAL_REG_INTERRUPT_ENABLE 1
+#define SERIAL_REG_DIVISOR_LOW 0
+#define SERIAL_REG_DIVISOR_HIGH 1
+#define SERIAL_REG_FIFO_CONTROL 2
+#define SERIAL_REG_LINE_CONTROL 3
+#define SERIAL_REG_MODEM_CONTROL 4
+#define SERIAL_REG_LINE_STATUS 5
+
+// 115200 baud
+#define SERIAL_DIVISOR 1
+
+#define SERIAL_LINE_CONTROL_8N1 0x03
+#define SERIAL_LINE_CONTROL_DLAB 0x80
+#define SERIAL_FIFO_ENABLE_AND_CLEAR 0xC7
+#define SERIAL_MODEM_CONTROL_DTR_RTS 0x03
+#define SERIAL_LINE_STATUS_TRANSMIT_EMPTY 0x20
+
+// Output before serial_initialize() is not sent, .bss is zeroed in boot.asm
+static bool serial_initialized;
+
+static void serial_write_register(uint8_t reg, uint8_t value)
+{
+    io_port_out_byte(SERIAL_COM1_IO_BASE + reg, value);
+}
+
+static uint8_t serial_read_register(uint8_t reg)
+{
+    return io_port_in_byte(SERIAL_COM1_IO_BASE + reg);
+}
+
+static void serial_write_byte(uint8_t byte)
+{
+    while ((serial_read_register(SERIAL_REG_LINE_STATUS) &
+            SERIAL_LINE_STATUS_TRANSMIT_EMPTY) == 0) {
+        ;
+    }
+    serial_write_register(SERIAL_REG_DATA, byte);
+}
+
+void serial_initialize(void)
+{
+    // The port is polled, no interrupts are used
+    serial_write_register(SERIAL_REG_INTERRUPT_ENABLE, 0x00);
+
+    serial_write_register(SERIAL_REG_LINE_CONTROL, SERIAL_LINE_CONTROL_DLAB);
+    serial_write_register(SERIAL_REG_DIVISOR_LOW, (uint8_t)SERIAL_DIVISOR);
+    serial_write_register(SERIAL_REG_DIVISOR_HIGH,
+                          (uint8_t)(SERIAL_DIVISOR >> 8));
+    serial_write_register(SERIAL_REG_LINE_CONTROL, SERIAL_LINE_CONTROL_8N1);
+
+    serial_write_register(SERIAL_REG_FIFO_CONTROL,
+                          SERIAL_FIFO_ENABLE_AND_CLEAR);
+    serial_write_register(SERIAL_REG_MODEM_CONTROL,
+                          SERIAL_MODEM_CONTROL_DTR_RTS);
+
+    serial_initialized = true;
+}
+
+void serial_putchar(char c)
+{
+    if (!serial_initialized) {
+        return;
+    }
+
+    if (c == '\n') {
+        serial_write_byte('\r');
+    }
+    serial_write_byte((uint8_t)c);
+}
@@ -0,0 +1,7 @@
+#ifndef SERIAL_H
+#define SERIAL_H
+
+void serial_initialize(void);
+void serial_putchar(char c);
+
+#endif
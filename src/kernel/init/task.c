@@ -0,0 +1,342 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clock.h"
+#include "cpu.h"
+#include "frame.h"
+#include "task.h"
+#include "terminal.h"
+#include "timer.h"
+
+/* Cooperative tasks
+ *
+ * A task runs until it yields, blocks on a completion, or returns from its
+ * entry function. Each task has a stack of one frame. The task running
+ * kernel_main uses the boot stack. When there is no task ready to run, the CPU
+ * is halted until an interrupt handler makes a task ready.
+ *
+ * The scheduler state is also changed from the interrupt handlers, so it is
+ * accessed only with the interrupts disabled.
+ */
+
+enum task_state {
+    TASK_STATE_UNUSED,
+    TASK_STATE_READY,
+    TASK_STATE_RUNNING,
+    TASK_STATE_BLOCKED,
+    TASK_STATE_DONE,
+};
+
+struct task {
+    uint32_t stack_pointer;
+    void *stack;
+    const char *name;
+    enum task_state state;
+    task_entry_t entry;
+    void *arg;
+    // Link in the run queue or in the list of the completion waiters
+    struct task *next;
+    struct task_completion exited;
+    uint32_t switch_count;
+    uint64_t runtime_cycles;
+    uint64_t switched_in_tsc;
+};
+
+// Implemented in context_switch.asm
+void context_switch(uint32_t *const old_stack_pointer,
+                    uint32_t new_stack_pointer);
+
+static struct task task_pool[TASK_MAX_COUNT];
+static struct task *task_current;
+static struct task *task_run_queue_head;
+static struct task *task_run_queue_tail;
+// Exited task whose stack can be freed only after switching away from it
+static struct task *task_exited;
+
+static uint64_t task_switch_start_tsc;
+static uint64_t task_switch_cycles;
+static uint32_t task_switch_count;
+static uint64_t task_idle_cycles;
+
+static void task_run_queue_push(struct task *const task)
+{
+    task->next = NULL;
+    if (task_run_queue_tail != NULL) {
+        task_run_queue_tail->next = task;
+    } else {
+        task_run_queue_head = task;
+    }
+    task_run_queue_tail = task;
+}
+
+static struct task *task_run_queue_pop(void)
+{
+    struct task *const task = task_run_queue_head;
+
+    if (task != NULL) {
+        task_run_queue_head = task->next;
+        if (task_run_queue_head == NULL) {
+            task_run_queue_tail = NULL;
+        }
+        task->next = NULL;
+    }
+
+    return task;
+}
+
+static void task_finish_switch(void)
+{
+    const uint64_t now = cpu_read_tsc();
+
+    task_switch_cycles += now - task_switch_start_tsc;
+    ++task_switch_count;
+    task_current->switched_in_tsc = now;
+
+    if (task_exited != NULL) {
+        frame_free(task_exited->stack);
+        task_exited->stack = NULL;
+        task_exited = NULL;
+    }
+}
+
+/* Switch to the next ready task. The state of the current task has to be set
+ * by the caller. Must be called with the interrupts disabled.
+ */
+static void task_schedule(void)
+{
+    struct task *const previous = task_current;
+    uint64_t now = cpu_read_tsc();
+
+    previous->runtime_cycles += now - previous->switched_in_tsc;
+
+    struct task *next;
+    while ((next = task_run_queue_pop()) == NULL) {
+        cpu_wait_for_interrupt();
+        cpu_disable_interrupts();
+
+        const uint64_t woken = cpu_read_tsc();
+        task_idle_cycles += woken - now;
+        now = woken;
+    }
+
+    next->state = TASK_STATE_RUNNING;
+    if (next == previous) {
+        previous->switched_in_tsc = now;
+        return;
+    }
+
+    if (previous->state == TASK_STATE_DONE) {
+        task_exited = previous;
+    }
+
+    ++next->switch_count;
+    task_current = next;
+    task_switch_start_tsc = cpu_read_tsc();
+    context_switch(&previous->stack_pointer, next->stack_pointer);
+
+    // Execution continues here when the previous task is switched back in
+    task_finish_switch();
+}
+
+static void task_exit(void)
+{
+    cpu_disable_interrupts();
+
+    task_completion_complete(&task_current->exited);
+    task_current->state = TASK_STATE_DONE;
+    task_schedule();
+}
+
+// First function executed by a new task
+static void task_start(void)
+{
+    task_finish_switch();
+    cpu_enable_interrupts();
+
+    task_current->entry(task_current->arg);
+
+    task_exit();
+}
+
+static void task_sleep_callback(void *arg)
+{
+    task_completion_complete((struct task_completion *)arg);
+}
+
+void task_initialize(void)
+{
+    for (uint8_t i = 0; i < TASK_MAX_COUNT; ++i) {
+        task_pool[i].state = TASK_STATE_UNUSED;
+    }
+
+    // The task executing kernel_main
+    task_current = &task_pool[0];
+    task_current->stack = NULL;
+    task_current->name = "main";
+    task_current->state = TASK_STATE_RUNNING;
+    task_completion_init(&task_current->exited);
+    task_current->switch_count = 0;
+    task_current->runtime_cycles = 0;
+    task_current->switched_in_tsc = cpu_read_tsc();
+
+    task_run_queue_head = NULL;
+    task_run_queue_tail = NULL;
+    task_exited = NULL;
+}
+
+struct task *task_create(const char *const name, task_entry_t entry,
+                         void *arg)
+{
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+    struct task *task = NULL;
+
+    for (uint8_t i = 0; i < TASK_MAX_COUNT; ++i) {
+        // Slots of the exited tasks are kept for the statistics until reused
+        if ((task_pool[i].state == TASK_STATE_UNUSED) ||
+            ((task_pool[i].state == TASK_STATE_DONE) &&
+             (task_pool[i].stack == NULL))) {
+            task = &task_pool[i];
+            break;
+        }
+    }
+
+    void *const stack = (task != NULL) ? frame_alloc() : NULL;
+
+    if (stack == NULL) {
+        cpu_restore_interrupts(flags);
+        return NULL;
+    }
+
+    task->stack = stack;
+    task->name = name;
+    task->entry = entry;
+    task->arg = arg;
+    task_completion_init(&task->exited);
+    task->switch_count = 0;
+    task->runtime_cycles = 0;
+
+    /* Build the stack as if the task had been switched out by
+     * context_switch() called from task_start(). The stack pointer is 16-byte
+     * aligned at the (never used) return address of task_start().
+     */
+    uint32_t *sp = (uint32_t *)((uint32_t)stack + FRAME_SIZE);
+    *--sp = 0;                    // Return address of task_start
+    *--sp = (uint32_t)task_start; // Return address of context_switch
+    *--sp = 0;                    // EBP
+    *--sp = 0;                    // EBX
+    *--sp = 0;                    // ESI
+    *--sp = 0;                    // EDI
+    task->stack_pointer = (uint32_t)sp;
+
+    task->state = TASK_STATE_READY;
+    task_run_queue_push(task);
+
+    cpu_restore_interrupts(flags);
+
+    return task;
+}
+
+void task_yield(void)
+{
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+
+    task_current->state = TASK_STATE_READY;
+    task_run_queue_push(task_current);
+    task_schedule();
+
+    cpu_restore_interrupts(flags);
+}
+
+void task_join(struct task *const task)
+{
+    task_completion_wait(&task->exited);
+}
+
+void task_sleep(uint64_t ns)
+{
+    struct task_completion completion;
+    struct timer timer = {0};
+
+    task_completion_init(&completion);
+    timer_arm(&timer, ns, task_sleep_callback, &completion);
+    task_completion_wait(&completion);
+}
+
+void task_completion_init(struct task_completion *const completion)
+{
+    completion->done = false;
+    completion->waiters = NULL;
+}
+
+void task_completion_wait(struct task_completion *const completion)
+{
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+
+    while (!completion->done) {
+        task_current->state = TASK_STATE_BLOCKED;
+        task_current->next = completion->waiters;
+        completion->waiters = task_current;
+        task_schedule();
+    }
+
+    cpu_restore_interrupts(flags);
+}
+
+void task_completion_complete(struct task_completion *const completion)
+{
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+
+    completion->done = true;
+    while (completion->waiters != NULL) {
+        struct task *const task = completion->waiters;
+        completion->waiters = task->next;
+        task->state = TASK_STATE_READY;
+        task_run_queue_push(task);
+    }
+
+    cpu_restore_interrupts(flags);
+}
+
+static uint32_t task_cycles_to_us(uint64_t cycles)
+{
+    return (uint32_t)((cycles * 1000) / clock_get_tsc_khz());
+}
+
+void task_print_statistics(void)
+{
+    static const char *const state_names[] = {
+        [TASK_STATE_UNUSED] = "unused",   [TASK_STATE_READY] = "ready",
+        [TASK_STATE_RUNNING] = "running", [TASK_STATE_BLOCKED] = "blocked",
+        [TASK_STATE_DONE] = "done",
+    };
+
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+
+    // Account the time of the current task up to now
+    const uint64_t now = cpu_read_tsc();
+    task_current->runtime_cycles += now - task_current->switched_in_tsc;
+    task_current->switched_in_tsc = now;
+
+    terminal_printf("\n");
+    terminal_printf("Tasks:\n");
+    for (uint8_t i = 0; i < TASK_MAX_COUNT; ++i) {
+        const struct task *const task = &task_pool[i];
+
+        if (task->state == TASK_STATE_UNUSED) {
+            continue;
+        }
+        terminal_printf("  %s: %s, switched in %u times, runtime %u us\n",
+                        task->name, state_names[task->state],
+                        task->switch_count,
+                        task_cycles_to_us(task->runtime_cycles));
+    }
+    terminal_printf("  idle: %u us\n", task_cycles_to_us(task_idle_cycles));
+    terminal_printf(
+        "  context switch: %u cycles on average\n",
+        (task_switch_count > 0)
+            ? (uint32_t)(task_switch_cycles / task_switch_count)
+            : 0);
+
+    cpu_restore_interrupts(flags);
+}
@@ -0,0 +1,35 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TASK_MAX_COUNT 8
+
+typedef void (*task_entry_t)(void *arg);
+
+struct task;
+
+/* A task waiting for a completion is blocked until another task or an
+ * interrupt handler completes it.
+ */
+struct task_completion {
+    bool done;
+    struct task *waiters;
+};
+
+void task_initialize(void);
+
+struct task *task_create(const char *const name, task_entry_t entry,
+                         void *arg);
+void task_yield(void);
+void task_join(struct task *const task);
+void task_sleep(uint64_t ns);
+
+void task_completion_init(struct task_completion *const completion);
+void task_completion_wait(struct task_completion *const completion);
+void task_completion_complete(struct task_completion *const completion);
+
+void task_print_statistics(void);
+
+#endif
@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "serial.h"
 #include "terminal.h"
 
 #define VGA_WIDTH 80
@@ -80,6 +81,9 @@ static void terminal_putchar_at(char c, size_t x, size_t y)
 
 static void terminal_putchar(char c)
 {
+    // Copy the output to the serial port so it can be captured outside the VM
+    serial_putchar(c);
+
     if (c != '\n') {
         terminal_putchar_at(c, terminal_column, terminal_row);
         if (++terminal_column == VGA_WIDTH) {
@@ -237,6 +241,9 @@ void terminal_initialize(void)
             terminal_putchar(' ');
         }
     }
+
+    // Initialized after clearing the display so the spaces are not sent
+    serial_initialize();
 }
 
 void terminal_printf(const char *const format, ...)
@@ -0,0 +1,319 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clock.h"
+#include "cpu.h"
+#include "interrupt.h"
+#include "lapic.h"
+#include "timer.h"
+
+/* Hierarchical timer wheel
+ *
+ * Time is measured in ticks of 2^20 ns (about 1 ms). Each level of the wheel
+ * has 64 slots, a slot of level N covers 64^N ticks. A timer is put into the
+ * lowest level that can hold its remaining time. When the lowest level wraps
+ * around, the current slot of the next level is cascaded, that is, its timers
+ * are put into the lower levels again.
+ *
+ * There is no periodic tick. The local APIC timer is programmed in one-shot
+ * mode for the next tick at which a slot has to be processed, and it is not
+ * programmed at all when no timer is armed.
+ */
+#define TIMER_LEVEL_BITS 6
+#define TIMER_LEVEL_SIZE (1U << TIMER_LEVEL_BITS)
+#define TIMER_LEVEL_MASK (TIMER_LEVEL_SIZE - 1)
+#define TIMER_LEVEL_COUNT 4
+#define TIMER_MAX_TICKS ((1U << (TIMER_LEVEL_BITS * TIMER_LEVEL_COUNT)) - 1)
+
+static struct timer *timer_wheel[TIMER_LEVEL_COUNT][TIMER_LEVEL_SIZE];
+// Next tick to be processed
+static uint32_t timer_base_tick;
+static uint32_t timer_armed_count;
+// Tick for which the local APIC timer interrupt is programmed
+static uint32_t timer_programmed_tick;
+static bool timer_interrupt_programmed;
+
+static uint32_t timer_ns_to_tick(uint64_t ns)
+{
+    return (uint32_t)(ns >> TIMER_TICK_SHIFT);
+}
+
+static void timer_list_add(struct timer **const head, struct timer *const timer)
+{
+    timer->next = *head;
+    if (timer->next != NULL) {
+        timer->next->pprev = &timer->next;
+    }
+    *head = timer;
+    timer->pprev = head;
+}
+
+static void timer_list_remove(struct timer *const timer)
+{
+    *timer->pprev = timer->next;
+    if (timer->next != NULL) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/* Set the tick at which the timer is processed next. A deadline farther than
+ * the wheel can hold is approached in steps of TIMER_MAX_TICKS, the timer is
+ * put into the wheel again in timer_expire() until the deadline is reached.
+ */
+static void timer_set_expires(struct timer *const timer, uint64_t now)
+{
+    const uint64_t now_tick = now >> TIMER_TICK_SHIFT;
+    const bool partial_tick =
+        (timer->deadline_ns & ((1U << TIMER_TICK_SHIFT) - 1)) != 0;
+    // Round up so the timer never expires early
+    uint64_t ticks =
+        (timer->deadline_ns >> TIMER_TICK_SHIFT) + partial_tick - now_tick;
+
+    if (ticks > TIMER_MAX_TICKS) {
+        ticks = TIMER_MAX_TICKS;
+    }
+    timer->expires = (uint32_t)(now_tick + ticks);
+}
+
+static void timer_enqueue(struct timer *const timer)
+{
+    uint32_t delta = timer->expires - timer_base_tick;
+
+    if ((int32_t)delta < 0) {
+        // Already expired, process it with the next tick
+        timer->expires = timer_base_tick;
+        delta = 0;
+    } else if (delta > TIMER_MAX_TICKS) {
+        timer->expires = timer_base_tick + TIMER_MAX_TICKS;
+        delta = TIMER_MAX_TICKS;
+    }
+
+    uint8_t level = 0;
+    while (delta >= (1U << (TIMER_LEVEL_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    const uint32_t index =
+        (timer->expires >> (TIMER_LEVEL_BITS * level)) & TIMER_LEVEL_MASK;
+    timer_list_add(&timer_wheel[level][index], timer);
+}
+
+static void timer_cascade(uint8_t level, uint32_t index)
+{
+    struct timer **const slot = &timer_wheel[level][index];
+
+    while (*slot != NULL) {
+        struct timer *const timer = *slot;
+        timer_list_remove(timer);
+        timer_enqueue(timer);
+    }
+}
+
+static void timer_expire(uint32_t index, uint64_t now)
+{
+    struct timer *expired = timer_wheel[0][index];
+
+    /* Move the timers to a separate list first. A timer armed by a callback
+     * may be put into the same slot for its next turn. Removing the timers
+     * from the list one by one allows a callback to cancel any of them.
+     */
+    timer_wheel[0][index] = NULL;
+    if (expired != NULL) {
+        expired->pprev = &expired;
+    }
+
+    while (expired != NULL) {
+        struct timer *const timer = expired;
+        timer_list_remove(timer);
+        if (timer->deadline_ns > now) {
+            // Only a timer with a deadline beyond the wheel gets here
+            timer_set_expires(timer, now);
+            timer_enqueue(timer);
+            continue;
+        }
+        --timer_armed_count;
+        timer->callback(timer->arg);
+    }
+}
+
+static void timer_process_tick(uint64_t now)
+{
+    const uint32_t index = timer_base_tick & TIMER_LEVEL_MASK;
+
+    if (index == 0) {
+        for (uint8_t level = 1; level < TIMER_LEVEL_COUNT; ++level) {
+            const uint32_t level_index =
+                (timer_base_tick >> (TIMER_LEVEL_BITS * level)) &
+                TIMER_LEVEL_MASK;
+            timer_cascade(level, level_index);
+            if (level_index != 0) {
+                break;
+            }
+        }
+    }
+
+    /* Advance before calling the callbacks, so the timers they arm are put
+     * relative to the next tick.
+     */
+    ++timer_base_tick;
+
+    timer_expire(index, now);
+}
+
+/* Find the earliest tick at which a non-empty slot has to be processed. For
+ * the upper levels, it is the tick at which the slot is cascaded.
+ */
+static uint32_t timer_find_next_tick(void)
+{
+    uint32_t next_delta = TIMER_MAX_TICKS;
+
+    for (uint8_t level = 0; level < TIMER_LEVEL_COUNT; ++level) {
+        const uint8_t shift = TIMER_LEVEL_BITS * level;
+        const uint32_t level_base = timer_base_tick >> shift;
+
+        /* The current slot of an upper level may hold timers for its next
+         * turn, so it is checked once more after the whole turn.
+         */
+        for (uint32_t i = 0; i <= TIMER_LEVEL_SIZE; ++i) {
+            const uint32_t tick = (level_base + i) << shift;
+            const uint32_t delta = tick - timer_base_tick;
+
+            if ((int32_t)delta < 0) {
+                // The slot has already been cascaded
+                continue;
+            }
+            if (delta >= next_delta) {
+                break;
+            }
+            if (timer_wheel[level][(level_base + i) & TIMER_LEVEL_MASK] !=
+                NULL) {
+                next_delta = delta;
+                break;
+            }
+        }
+    }
+
+    return timer_base_tick + next_delta;
+}
+
+static void timer_program_next_interrupt(void)
+{
+    if (timer_armed_count == 0) {
+        lapic_timer_stop();
+        timer_interrupt_programmed = false;
+        return;
+    }
+
+    const uint64_t now = ktime_ns();
+    timer_programmed_tick = timer_find_next_tick();
+    timer_interrupt_programmed = true;
+    const uint32_t ticks_ahead = timer_programmed_tick - timer_ns_to_tick(now);
+    uint64_t delay = 0;
+
+    if ((int32_t)ticks_ahead > 0) {
+        delay = (((uint64_t)ticks_ahead) << TIMER_TICK_SHIFT) -
+                (now & ((1U << TIMER_TICK_SHIFT) - 1));
+    }
+
+    lapic_timer_start(clock_ns_to_lapic_timer_count(delay));
+}
+
+static void timer_run(void)
+{
+    const uint64_t now = ktime_ns();
+    const uint32_t now_tick = timer_ns_to_tick(now);
+
+    while (timer_armed_count > 0) {
+        const uint32_t next_tick = timer_find_next_tick();
+
+        if ((int32_t)(next_tick - now_tick) > 0) {
+            break;
+        }
+        // Nothing has to be done for the ticks in between
+        timer_base_tick = next_tick;
+        timer_process_tick(now);
+    }
+
+    if ((int32_t)(now_tick - timer_base_tick) >= 0) {
+        timer_base_tick = now_tick + 1;
+    }
+
+    timer_program_next_interrupt();
+}
+
+static void timer_interrupt_handler(struct interrupt_frame *const frame)
+{
+    (void)frame;
+
+    timer_run();
+    lapic_end_of_interrupt();
+}
+
+void timer_initialize(void)
+{
+    timer_base_tick = timer_ns_to_tick(ktime_ns());
+    timer_armed_count = 0;
+    timer_interrupt_programmed = false;
+
+    interrupt_set_handler(INTERRUPT_VECTOR_LAPIC_TIMER,
+                          timer_interrupt_handler);
+}
+
+void timer_arm(struct timer *const timer, uint64_t ns,
+               timer_callback_t callback, void *arg)
+{
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+
+    if (timer_is_armed(timer)) {
+        timer_list_remove(timer);
+        --timer_armed_count;
+    }
+
+    const uint64_t now = ktime_ns();
+
+    if (timer_armed_count == 0) {
+        // The wheel has not been advanced while it was empty
+        timer_base_tick = timer_ns_to_tick(now);
+    }
+
+    timer->deadline_ns = (ns > (UINT64_MAX - now)) ? UINT64_MAX : (now + ns);
+    timer_set_expires(timer, now);
+    timer->callback = callback;
+    timer->arg = arg;
+    timer_enqueue(timer);
+    ++timer_armed_count;
+
+    /* The wheel is searched only when the timer expires before the programmed
+     * interrupt. Otherwise, it is taken into account when the interrupt
+     * programs the next one.
+     */
+    if (!timer_interrupt_programmed ||
+        ((int32_t)(timer->expires - timer_programmed_tick) < 0)) {
+        timer_program_next_interrupt();
+    }
+
+    cpu_restore_interrupts(flags);
+}
+
+bool timer_cancel(struct timer *const timer)
+{
+    const uint32_t flags = cpu_save_and_disable_interrupts();
+    const bool armed = timer_is_armed(timer);
+
+    if (armed) {
+        timer_list_remove(timer);
+        --timer_armed_count;
+    }
+
+    cpu_restore_interrupts(flags);
+
+    return armed;
+}
+
+bool timer_is_armed(const struct timer *const timer)
+{
+    return (timer->pprev != NULL);
+}
@@ -0,0 +1,35 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Resolution of the timers, about 1 ms
+#define TIMER_TICK_SHIFT 20
+#define TIMER_TICK_NS (1ULL << TIMER_TICK_SHIFT)
+
+typedef void (*timer_callback_t)(void *arg);
+
+/* A timer is owned by its user, the timer subsystem only links it into the
+ * timer wheel while it is armed. The callback is called from the interrupt
+ * handler with interrupts disabled. A timer has to be zero-initialized before
+ * it is armed for the first time.
+ */
+struct timer {
+    struct timer *next;
+    struct timer **pprev;
+    // Tick at which the timer is processed next, at most about 4.9 h ahead
+    uint32_t expires;
+    uint64_t deadline_ns;
+    timer_callback_t callback;
+    void *arg;
+};
+
+void timer_initialize(void);
+
+void timer_arm(struct timer *const timer, uint64_t ns,
+               timer_callback_t callback, void *arg);
+bool timer_cancel(struct timer *const timer);
+bool timer_is_armed(const struct timer *const timer);
+
+#endif
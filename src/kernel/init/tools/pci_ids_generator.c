@@ -0,0 +1,517 @@
+/* Generator of the PCI ID name tables
+ *
+ * Runs on the build machine. It reads a file in the format of pci.ids from
+ * The PCI ID Repository and writes a C source file with minimal perfect hash
+ * tables of the vendor, device and class names (see pci_ids_hash.h). The names
+ * are stored in a pool of null-terminated strings in which every string is
+ * stored only once. A string which is a suffix of another one shares its
+ * bytes.
+ *
+ * Usage: pci_ids_generator pci.ids > pci_ids_table.c
+ *
+ * A summary of the sizes of the tables is printed to the standard error
+ * output.
+ */
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../pci_ids_hash.h"
+
+#define LINE_MAX_LENGTH 512
+
+// Average number of keys in a bucket
+#define BUCKET_LOAD 4
+#define DISPLACEMENT_COUNT 0x10000
+#define SEED_MAX_ATTEMPTS 1000
+
+#define STRING_POOL_MAX_SIZE 0x10000
+
+// Size of struct pci_ids_table in the 32-bit kernel
+#define TABLE_HEADER_SIZE 20
+
+struct entry {
+    uint32_t key;
+    const char *name;
+    uint16_t name_offset;
+};
+
+struct entry_list {
+    struct entry *entries;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+struct table {
+    const char *name;
+    struct entry_list list;
+    uint32_t seed;
+    uint32_t bucket_count;
+    uint16_t *displacements;
+    // Indices into the entry list, ordered by the slots
+    uint32_t *slots;
+};
+
+static char string_pool[STRING_POOL_MAX_SIZE];
+static uint32_t string_pool_size;
+
+static void fail(const char *const message, const char *const detail)
+{
+    fprintf(stderr, "pci_ids_generator: %s%s%s\n", message,
+            (detail != NULL) ? ": " : "", (detail != NULL) ? detail : "");
+    exit(EXIT_FAILURE);
+}
+
+static void *allocate(size_t size)
+{
+    void *const p = calloc(1, (size > 0) ? size : 1);
+
+    if (p == NULL) {
+        fail("Out of memory", NULL);
+    }
+
+    return p;
+}
+
+static void entry_list_add(struct entry_list *const list, uint32_t key,
+                           const char *const name)
+{
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity > 0) ? (2 * list->capacity) : 64;
+        list->entries =
+            realloc(list->entries, list->capacity * sizeof(struct entry));
+        if (list->entries == NULL) {
+            fail("Out of memory", NULL);
+        }
+    }
+
+    const size_t length = strlen(name);
+    char *const copy = allocate(length + 1);
+    memcpy(copy, name, length + 1);
+
+    list->entries[list->count].key = key;
+    list->entries[list->count].name = copy;
+    list->entries[list->count].name_offset = 0;
+    ++list->count;
+}
+
+/* Parse "<hex ID>  <name>". Returns false if the line does not start with
+ * exactly the given number of hexadecimal digits.
+ */
+static bool parse_id_and_name(const char *line, uint8_t digits,
+                              uint32_t *const id, const char **const name)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < digits; ++i) {
+        if (!isxdigit((unsigned char)line[i])) {
+            return false;
+        }
+        const char c = (char)tolower((unsigned char)line[i]);
+        value = (value << 4) |
+                (uint32_t)((c <= '9') ? (c - '0') : (c - 'a' + 10));
+    }
+    line += digits;
+
+    if (!isspace((unsigned char)*line)) {
+        return false;
+    }
+    while (isspace((unsigned char)*line)) {
+        ++line;
+    }
+    if (*line == '\0') {
+        return false;
+    }
+
+    *id = value;
+    *name = line;
+
+    return true;
+}
+
+static void parse_file(const char *const path, struct table *const vendors,
+                       struct table *const devices,
+                       struct table *const classes)
+{
+    FILE *const file = fopen(path, "r");
+    char line[LINE_MAX_LENGTH];
+    bool in_classes = false;
+    bool has_vendor = false;
+    uint32_t vendor_id = 0;
+    uint32_t class_code = 0;
+    uint32_t subclass = 0;
+
+    if (file == NULL) {
+        fail("Cannot open", path);
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if ((line[0] == '\0') || (line[0] == '#')) {
+            continue;
+        }
+
+        uint32_t id;
+        const char *name;
+
+        if ((line[0] == 'C') && (line[1] == ' ')) {
+            // Class
+            if (!parse_id_and_name(&line[2], 2, &id, &name)) {
+                fail("Invalid class line", line);
+            }
+            in_classes = true;
+            class_code = id;
+            entry_list_add(&classes->list, PCI_IDS_CLASS_KEY(class_code),
+                           name);
+        } else if (in_classes && (line[0] == '\t') && (line[1] == '\t')) {
+            // Programming interface
+            if (!parse_id_and_name(&line[2], 2, &id, &name)) {
+                fail("Invalid programming interface line", line);
+            }
+            entry_list_add(&classes->list,
+                           PCI_IDS_PROG_IF_KEY(class_code, subclass, id),
+                           name);
+        } else if (in_classes && (line[0] == '\t')) {
+            // Subclass
+            if (!parse_id_and_name(&line[1], 2, &id, &name)) {
+                fail("Invalid subclass line", line);
+            }
+            subclass = id;
+            entry_list_add(&classes->list,
+                           PCI_IDS_SUBCLASS_KEY(class_code, subclass), name);
+        } else if (in_classes) {
+            // Other sections of the file (e.g. "L" for languages) are ignored
+            in_classes = false;
+            has_vendor = false;
+        } else if ((line[0] == '\t') && (line[1] == '\t')) {
+            // Subsystems are not used
+            continue;
+        } else if (line[0] == '\t') {
+            // Device
+            if (!has_vendor || !parse_id_and_name(&line[1], 4, &id, &name)) {
+                fail("Invalid device line", line);
+            }
+            entry_list_add(&devices->list, PCI_IDS_DEVICE_KEY(vendor_id, id),
+                           name);
+        } else if (parse_id_and_name(line, 4, &id, &name)) {
+            // Vendor
+            has_vendor = true;
+            vendor_id = id;
+            entry_list_add(&vendors->list, PCI_IDS_VENDOR_KEY(vendor_id),
+                           name);
+        } else {
+            // Unknown section
+            has_vendor = false;
+        }
+    }
+
+    fclose(file);
+}
+
+static void string_pool_add(struct entry *const entry)
+{
+    const size_t length = strlen(entry->name) + 1;
+
+    // Look for the string, including its terminator, anywhere in the pool
+    for (uint32_t offset = 0; (offset + length) <= string_pool_size;
+         ++offset) {
+        if (memcmp(&string_pool[offset], entry->name, length) == 0) {
+            entry->name_offset = (uint16_t)offset;
+            return;
+        }
+    }
+
+    if ((string_pool_size + length) > STRING_POOL_MAX_SIZE) {
+        fail("String pool too large", NULL);
+    }
+    memcpy(&string_pool[string_pool_size], entry->name, length);
+    entry->name_offset = (uint16_t)string_pool_size;
+    string_pool_size += length;
+}
+
+static int compare_name_length_descending(const void *a, const void *b)
+{
+    const size_t length_a = strlen((*(struct entry *const *)a)->name);
+    const size_t length_b = strlen((*(struct entry *const *)b)->name);
+
+    return (length_a < length_b) - (length_a > length_b);
+}
+
+/* Longer strings are added first, so the shorter ones can be found as their
+ * suffixes.
+ */
+static void build_string_pool(struct table *const tables, uint8_t table_count)
+{
+    uint32_t count = 0;
+
+    for (uint8_t t = 0; t < table_count; ++t) {
+        count += tables[t].list.count;
+    }
+
+    struct entry **const entries = allocate(count * sizeof(struct entry *));
+    uint32_t i = 0;
+    for (uint8_t t = 0; t < table_count; ++t) {
+        for (uint32_t e = 0; e < tables[t].list.count; ++e) {
+            entries[i++] = &tables[t].list.entries[e];
+        }
+    }
+
+    qsort(entries, count, sizeof(struct entry *),
+          compare_name_length_descending);
+    for (i = 0; i < count; ++i) {
+        string_pool_add(entries[i]);
+    }
+
+    free(entries);
+}
+
+static void check_unique_keys(const struct table *const table)
+{
+    const struct entry_list *const list = &table->list;
+
+    for (uint32_t i = 0; i < list->count; ++i) {
+        for (uint32_t j = i + 1; j < list->count; ++j) {
+            if (list->entries[i].key == list->entries[j].key) {
+                fail("Duplicate entry", list->entries[j].name);
+            }
+        }
+    }
+}
+
+/* Try to find the displacements for the given seed. The buckets with more
+ * keys are placed first while there are still many free slots.
+ */
+static bool try_build_table(struct table *const table, uint32_t seed)
+{
+    const struct entry_list *const list = &table->list;
+    const uint32_t bucket_count = table->bucket_count;
+    uint32_t *const bucket_sizes = allocate(bucket_count * sizeof(uint32_t));
+    uint32_t *const entry_buckets = allocate(list->count * sizeof(uint32_t));
+    bool *const slot_used = allocate(list->count * sizeof(bool));
+    uint32_t *const bucket_slots = allocate(list->count * sizeof(uint32_t));
+    bool success = true;
+
+    for (uint32_t e = 0; e < list->count; ++e) {
+        entry_buckets[e] =
+            pci_ids_hash_bucket(list->entries[e].key, seed, bucket_count);
+        ++bucket_sizes[entry_buckets[e]];
+    }
+
+    for (uint32_t size = list->count; (size > 0) && success; --size) {
+        for (uint32_t b = 0; (b < bucket_count) && success; ++b) {
+            if (bucket_sizes[b] != size) {
+                continue;
+            }
+
+            bool placed = false;
+            for (uint32_t d = 0; (d < DISPLACEMENT_COUNT) && !placed; ++d) {
+                uint32_t n = 0;
+                placed = true;
+                for (uint32_t e = 0; (e < list->count) && placed; ++e) {
+                    if (entry_buckets[e] != b) {
+                        continue;
+                    }
+                    const uint32_t slot =
+                        pci_ids_hash_slot(list->entries[e].key, seed,
+                                          (uint16_t)d, list->count);
+                    if (slot_used[slot]) {
+                        placed = false;
+                    }
+                    for (uint32_t i = 0; (i < n) && placed; ++i) {
+                        if (bucket_slots[i] == slot) {
+                            placed = false;
+                        }
+                    }
+                    bucket_slots[n++] = slot;
+                }
+
+                if (placed) {
+                    table->displacements[b] = (uint16_t)d;
+                    n = 0;
+                    for (uint32_t e = 0; e < list->count; ++e) {
+                        if (entry_buckets[e] == b) {
+                            slot_used[bucket_slots[n]] = true;
+                            table->slots[bucket_slots[n]] = e;
+                            ++n;
+                        }
+                    }
+                }
+            }
+            success = placed;
+        }
+    }
+
+    free(bucket_sizes);
+    free(entry_buckets);
+    free(slot_used);
+    free(bucket_slots);
+
+    return success;
+}
+
+static void build_table(struct table *const table)
+{
+    const uint32_t count = table->list.count;
+
+    check_unique_keys(table);
+
+    table->bucket_count = (count + BUCKET_LOAD - 1) / BUCKET_LOAD;
+    if (table->bucket_count == 0) {
+        table->bucket_count = 1;
+    }
+    if (table->bucket_count > UINT16_MAX) {
+        fail("Too many entries", table->name);
+    }
+    table->displacements = allocate(table->bucket_count * sizeof(uint16_t));
+    table->slots = allocate(count * sizeof(uint32_t));
+
+    for (uint32_t seed = 0; seed < SEED_MAX_ATTEMPTS; ++seed) {
+        memset(table->displacements, 0,
+               table->bucket_count * sizeof(uint16_t));
+        if (try_build_table(table, seed)) {
+            table->seed = seed;
+            return;
+        }
+    }
+
+    fail("Cannot build a perfect hash", table->name);
+}
+
+static uint32_t table_size(const struct table *const table)
+{
+    return TABLE_HEADER_SIZE + (table->bucket_count * sizeof(uint16_t)) +
+           (table->list.count * (sizeof(uint32_t) + sizeof(uint16_t)));
+}
+
+static void print_string_pool(void)
+{
+    printf("const char pci_ids_string_pool[] = {\n");
+
+    uint32_t offset = 0;
+    while (offset < string_pool_size) {
+        const char *const string = &string_pool[offset];
+        const size_t length = strlen(string) + 1;
+
+        printf("    // %u: ", offset);
+        for (size_t i = 0; i < (length - 1); ++i) {
+            // Do not let a backslash continue the comment on the next line
+            putchar((string[i] == '\\') ? '/' : string[i]);
+        }
+        printf("\n   ");
+        for (size_t i = 0; i < length; ++i) {
+            printf(" 0x%02x,", (unsigned char)string[i]);
+            if (((i % 12) == 11) && (i != (length - 1))) {
+                printf("\n   ");
+            }
+        }
+        printf("\n");
+
+        offset += (uint32_t)length;
+    }
+
+    printf("};\n\n");
+}
+
+static void print_table(const struct table *const table)
+{
+    const struct entry_list *const list = &table->list;
+
+    if (list->count == 0) {
+        printf("const struct pci_ids_table pci_ids_%s = {\n", table->name);
+        printf("    .seed = 0,\n");
+        printf("    .bucket_count = 0,\n");
+        printf("    .entry_count = 0,\n");
+        printf("    .displacements = 0,\n");
+        printf("    .keys = 0,\n");
+        printf("    .name_offsets = 0,\n");
+        printf("};\n\n");
+        return;
+    }
+
+    printf("static const uint16_t pci_ids_%s_displacements[] = {",
+           table->name);
+    for (uint32_t b = 0; b < table->bucket_count; ++b) {
+        printf("%s %u,", ((b % 8) == 0) ? "\n   " : "",
+               table->displacements[b]);
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint32_t pci_ids_%s_keys[] = {", table->name);
+    for (uint32_t s = 0; s < list->count; ++s) {
+        printf("%s 0x%08xU,", ((s % 4) == 0) ? "\n   " : "",
+               list->entries[table->slots[s]].key);
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint16_t pci_ids_%s_name_offsets[] = {", table->name);
+    for (uint32_t s = 0; s < list->count; ++s) {
+        printf("%s %u,", ((s % 8) == 0) ? "\n   " : "",
+               list->entries[table->slots[s]].name_offset);
+    }
+    printf("\n};\n\n");
+
+    printf("const struct pci_ids_table pci_ids_%s = {\n", table->name);
+    printf("    .seed = %uU,\n", table->seed);
+    printf("    .bucket_count = %u,\n", table->bucket_count);
+    printf("    .entry_count = %u,\n", list->count);
+    printf("    .displacements = pci_ids_%s_displacements,\n", table->name);
+    printf("    .keys = pci_ids_%s_keys,\n", table->name);
+    printf("    .name_offsets = pci_ids_%s_name_offsets,\n", table->name);
+    printf("};\n\n");
+}
+
+int main(int argc, char **argv)
+{
+    struct table tables[] = {
+        {.name = "vendors"},
+        {.name = "devices"},
+        {.name = "classes"},
+    };
+    const uint8_t table_count = sizeof(tables) / sizeof(tables[0]);
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s pci.ids > pci_ids_table.c\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    parse_file(argv[1], &tables[0], &tables[1], &tables[2]);
+    build_string_pool(tables, table_count);
+
+    uint32_t total_size = string_pool_size;
+    for (uint8_t t = 0; t < table_count; ++t) {
+        build_table(&tables[t]);
+        total_size += table_size(&tables[t]);
+    }
+
+    printf("/* Generated by tools/pci_ids_generator.c from %s. Do not edit.\n",
+           argv[1]);
+    printf(" *\n");
+    for (uint8_t t = 0; t < table_count; ++t) {
+        printf(" * %s: %u entries, %u buckets, %u bytes\n", tables[t].name,
+               tables[t].list.count, tables[t].bucket_count,
+               table_size(&tables[t]));
+    }
+    printf(" * string pool: %u bytes\n", string_pool_size);
+    printf(" * total: %u bytes\n", total_size);
+    printf(" */\n\n");
+    printf("#include <stdint.h>\n\n");
+    printf("#include \"pci_ids_table.h\"\n\n");
+
+    print_string_pool();
+    for (uint8_t t = 0; t < table_count; ++t) {
+        print_table(&tables[t]);
+    }
+
+    fprintf(stderr,
+            "PCI ID tables: %u vendors, %u devices, %u classes, "
+            "%u bytes of strings, %u bytes in total\n",
+            tables[0].list.count, tables[1].list.count, tables[2].list.count,
+            string_pool_size, total_size);
+
+    return EXIT_SUCCESS;
+}